@@ -0,0 +1,107 @@
+/*
+bench_blit.cpp - Frame buffer text blitter benchmark for TeenyPrtVal (env:native).
+
+Renders text through print() of a display that draws glyphs pixel by pixel the way
+Adafruit GFX drawChar() does, and through the 1bpp frame buffer blitter, checks that
+both produce the same frame buffer and times them on page-aligned and unaligned rows.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include "TeenyPrtVal.h"
+
+static const int benchBlitCalls = 20000;
+
+// 128x64 SSD1306 style display whose print() sets pixels one at a time
+struct PixelDisplay {
+  static const int16_t width = 128;
+  static const int16_t height = 64;
+  uint8_t buffer[width * height / 8];
+  int16_t cursorX = 0;
+  int16_t cursorY = 0;
+  boolean inverse = false;
+  uint32_t prints = 0;
+
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  void drawPixel(int16_t x, int16_t y, boolean on) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    if (on != inverse) {
+      buffer[x + (y / 8) * width] |= (1 << (y & 7));
+    } else {
+      buffer[x + (y / 8) * width] &= ~(1 << (y & 7));
+    }
+  }
+  // Opaque 6x8 cell per character, like drawChar() with a background color
+  void print(const char* str) {
+    prints++;
+    for (; *str; ++str, cursorX += 6) {
+      for (int i=0; i<6; i++) {
+        int column = TeenyPrtVal<PixelDisplay>::font_column(*str, i);
+        for (int j=0; j<8; j++) {
+          drawPixel(cursorX + i, cursorY + j, (column >> j) & 1);
+        }
+      }
+    }
+  }
+};
+
+static const char* benchBlitText = "Brightness:  125 \x12";
+
+// Compare blitted and pixel drawn text for rows and columns around the edges, return number of mismatches
+static int checkBlit() {
+  static PixelDisplay expected;
+  static PixelDisplay actual;
+  TeenyPrtVal<PixelDisplay> reference(expected);
+  TeenyPrtVal<PixelDisplay> blitter(actual);
+  static const int rows[] = { -9, -3, 0, 1, 7, 8, 13, 56, 59, 64 };
+  static const int cols[] = { -7, 0, 5, 100 };
+  int mismatches = 0;
+  for (int inverse=0; inverse<2; inverse++) {
+    expected.inverse = inverse;
+    blitter.setFrameBuffer(actual.buffer, PixelDisplay::width, PixelDisplay::height, inverse);
+    for (int row : rows) {
+      for (int col : cols) {
+        // Start from a pattern, so that pixels outside of the text cells must be left alone
+        for (int i=0; i<(int)sizeof(expected.buffer); i++) {
+          expected.buffer[i] = actual.buffer[i] = (uint8_t)(i * 37);
+        }
+        reference.prt_str(benchBlitText, 18, col, row);
+        reference.prt_char('\xAF', 1);
+        blitter.prt_str(benchBlitText, 18, col, row);
+        blitter.prt_char('\xAF', 1);
+        mismatches += (memcmp(expected.buffer, actual.buffer, sizeof(expected.buffer)) != 0);
+      }
+    }
+  }
+  // Nothing went through print(), except text with a character missing from the font
+  mismatches += (actual.prints != 0);
+  blitter.prt_str("\x01", 1, 0, 0);
+  mismatches += (actual.prints != 1);
+  return mismatches;
+}
+
+template <class F>
+static double nsPerRow(F draw) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<benchBlitCalls; i++) {
+    draw(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / benchBlitCalls;
+}
+
+void benchBlit() {
+  printf("blitter: %d mismatches against pixel drawn text\n", checkBlit());
+  static PixelDisplay pixelDisplay;
+  static PixelDisplay blitDisplay;
+  TeenyPrtVal<PixelDisplay> pixel(pixelDisplay);
+  TeenyPrtVal<PixelDisplay> blit(blitDisplay);
+  blit.setFrameBuffer(blitDisplay.buffer, PixelDisplay::width, PixelDisplay::height);
+  printf("%-10s %12s %12s\n", "21 chars", "pixel ns", "blit ns");
+  printf("%-10s %12.1f %12.1f\n", "aligned",
+         nsPerRow([&](int i) { pixel.prt_str(benchBlitText, 21, 0, (i & 7) * 8); }),
+         nsPerRow([&](int i) { blit.prt_str(benchBlitText, 21, 0, (i & 7) * 8); }));
+  printf("%-10s %12.1f %12.1f\n", "unaligned",
+         nsPerRow([&](int i) { pixel.prt_str(benchBlitText, 21, 0, (i % 6) * 9 + 10); }),
+         nsPerRow([&](int i) { blit.prt_str(benchBlitText, 21, 0, (i % 6) * 9 + 10); }));
+  printf("(checksum %02X)\n\n", (unsigned)(pixelDisplay.buffer[300] ^ blitDisplay.buffer[300]));
+}
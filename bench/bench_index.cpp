@@ -0,0 +1,295 @@
+/*
+bench_index.cpp - Path lookup benchmark for TeenyMenuIndex (env:native).
+
+Builds a page tree with pages shared by several groups and links back to the root page,
+resolves the path of every item through the index and by walking the pages title by title,
+checking both find the same items (and neither finds malformed paths), and times them. Then
+jumps to items with TeenyMenu::navigateTo(), checking the page, the focused item, that the
+menu was drawn once and as drawMenu() draws it and that Back goes up the path, and sets and
+gets values by path. Last, builds the index of a tree with more item paths than it takes.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include "MockDisplay.h"
+#include "TeenyMenu.h"
+
+static const int benchIndexGroups = 8;
+static const int benchIndexValues = 20;
+static const int benchIndexParams = 10;
+static const int benchIndexShared = 5;
+static const int benchIndexLookups = 200000;
+
+static int benchIndexMin = -1000;
+static int benchIndexMax = 1000;
+static TeenyMenuRange benchIndexRange{&benchIndexMin, &benchIndexMax, nullptr, 0};
+static SelectOptionInt benchIndexOptions[] = { {"Low", 1}, {"Mid", 5}, {"High", 9} };
+static TeenyMenuSelect benchIndexSelect(3, benchIndexOptions);
+static int benchIndexSaves = 0;
+
+static void benchIndexSave() {
+  benchIndexSaves++;
+}
+
+struct BenchIndexTree {
+  TeenyMenuPage root;
+  TeenyMenuPage shared;
+  std::vector<TeenyMenuPage*> pages;
+  std::vector<TeenyMenuItem*> items;
+  std::vector<std::string> titles;
+  std::map<TeenyMenuItem*, TeenyMenuPage*> links;  // Page each link item links to
+  int values[benchIndexGroups][benchIndexValues + benchIndexParams] = {};
+  int sharedValues[benchIndexShared] = {};
+  int selectValue = 5;
+  boolean flag = false;
+
+  BenchIndexTree() : root("MAIN"), shared("SHARED") {
+    // Titles are kept apart, so that items can point to them
+    titles.reserve(benchIndexGroups + benchIndexValues + benchIndexParams + benchIndexShared);
+    for (int g=0; g<benchIndexGroups; g++) titles.push_back("Group" + std::to_string(g));
+    for (int i=0; i<benchIndexValues; i++) titles.push_back("Value" + std::to_string(i));
+    for (int i=0; i<benchIndexParams; i++) titles.push_back("Param" + std::to_string(i));
+    for (int i=0; i<benchIndexShared; i++) titles.push_back("Common" + std::to_string(i));
+    for (int i=0; i<benchIndexShared; i++) {
+      add(shared, new TeenyMenuItem(title(benchIndexGroups + benchIndexValues + benchIndexParams + i), sharedValues[i], benchIndexRange, benchIndexSave));
+    }
+    add(shared, new TeenyMenuItem("Home", root), &root);
+    for (int g=0; g<benchIndexGroups; g++) {
+      TeenyMenuPage* group = new TeenyMenuPage(title(g));
+      TeenyMenuPage* detail = new TeenyMenuPage("DETAIL");
+      pages.push_back(group);
+      pages.push_back(detail);
+      add(*group, new TeenyMenuItem());
+      for (int i=0; i<benchIndexValues; i++) {
+        const char* itemTitle = title(benchIndexGroups + i);
+        switch (i % 10) {
+          case 3:
+            add(*group, new TeenyMenuItem(itemTitle, selectValue, benchIndexSelect, benchIndexSave));
+            break;
+          case 4:
+            add(*group, new TeenyMenuItem(itemTitle, flag, benchIndexSave));
+            break;
+          case 7:
+            add(*group, new TeenyMenuItem(itemTitle, values[g][i], benchIndexRange, nullptr, TEENYMENU_READONLY));
+            break;
+          default:
+            add(*group, new TeenyMenuItem(itemTitle, values[g][i], benchIndexRange, benchIndexSave));
+            break;
+        }
+      }
+      add(*group, new TeenyMenuItem("Detail", *detail), detail);
+      add(*detail, new TeenyMenuItem());
+      for (int i=0; i<benchIndexParams; i++) {
+        add(*detail, new TeenyMenuItem(title(benchIndexGroups + benchIndexValues + i), values[g][benchIndexValues + i], benchIndexRange));
+      }
+      add(*detail, new TeenyMenuItem("Shared", shared), &shared);
+      add(*detail, new TeenyMenuItem("Home", root), &root);
+      add(root, new TeenyMenuItem(title(g), *group), group);
+    }
+  }
+
+  ~BenchIndexTree() {
+    for (TeenyMenuItem* item : items) delete item;
+    for (TeenyMenuPage* page : pages) delete page;
+  }
+
+  const char* title(int i) { return titles[i].c_str(); }
+
+  void add(TeenyMenuPage& page, TeenyMenuItem* item, TeenyMenuPage* linked = nullptr) {
+    items.push_back(item);
+    page.addMenuItem(*item);
+    if (linked != nullptr) links[item] = linked;
+  }
+
+  TeenyMenuPage* linkedPage(TeenyMenuItem* item) {
+    auto link = links.find(item);
+    return (link != links.end()) ? link->second : nullptr;
+  }
+};
+
+// Resolve a path by walking the pages from the root, comparing the titles of their items in turn
+static TeenyMenuItem* benchIndexWalk(BenchIndexTree& tree, const char* path) {
+  TeenyMenuPage* page = &tree.root;
+  TeenyMenuItem* found = nullptr;
+  const char* segment = path;
+  while (true) {
+    const char* end = strchr(segment, '/');
+    size_t len = end ? (size_t)(end - segment) : strlen(segment);
+    if (page == nullptr || len == 0) return nullptr;
+    found = nullptr;
+    for (int i=0; ; i++) {
+      TeenyMenuItem* item = page->getMenuItem(i, true);
+      if (item == nullptr) return nullptr;
+      const char* itemTitle = item->getTitle();
+      if (strlen(itemTitle) == len && memcmp(itemTitle, segment, len) == 0) {
+        found = item;
+        break;
+      }
+    }
+    if (end == nullptr) return found;
+    page = tree.linkedPage(found);
+    segment = end + 1;
+  }
+}
+
+// Paths of the items reached from the page, without going through a page twice
+static void benchIndexPaths(BenchIndexTree& tree, TeenyMenuPage* page, const std::string& prefix,
+                            std::vector<TeenyMenuPage*>& onPath, std::vector<std::string>& paths) {
+  for (TeenyMenuPage* p : onPath) {
+    if (p == page) return;
+  }
+  onPath.push_back(page);
+  for (int i=0; ; i++) {
+    TeenyMenuItem* item = page->getMenuItem(i, true);
+    if (item == nullptr) break;
+    if (item->getTitle()[0] == '\0') continue;
+    std::string path = prefix + item->getTitle();
+    paths.push_back(path);
+    if (tree.linkedPage(item) != nullptr) {
+      benchIndexPaths(tree, tree.linkedPage(item), path + "/", onPath, paths);
+    }
+  }
+  onPath.pop_back();
+}
+
+template <class F>
+static double nsPerLookup(const std::vector<std::string>& paths, F lookup) {
+  uintptr_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<benchIndexLookups; i++) {
+    checksum += (uintptr_t)lookup(paths[i % paths.size()].c_str());
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / benchIndexLookups;
+  return (checksum == 1) ? 0 : ns;
+}
+
+// A page linked from each of 200 items of another page: 40200 item paths, more than the index takes, so build()
+// fails, without running out of empty hash table slots; the items indexed first are found, missing paths are not
+static int benchIndexCapped() {
+  static const int width = 200;
+  static char titles[width][8];
+  TeenyMenuPage wide("WIDE");
+  TeenyMenuPage shared("SHARED");
+  std::vector<TeenyMenuItem> items;
+  items.reserve(width * 2);
+  for (int i=0; i<width; i++) {
+    snprintf(titles[i], sizeof(titles[i]), "N%d", i);
+    items.emplace_back(titles[i], shared);
+    wide.addMenuItem(items.back());
+    items.emplace_back(titles[i]);
+    shared.addMenuItem(items.back());
+  }
+  TeenyMenuIndex index;
+  int mismatches = index.build(wide);
+  mismatches += (index.getItemsCount() == 0 || index.getItemsCount() >= 0x8000);
+  mismatches += (index.getMenuItem("N0") != &items[0] || index.getMenuItem("N0/N1") != &items[3]);
+  mismatches += (index.getMenuItem("N0/Nope") != nullptr || index.getMenuItem("N199/N199") != nullptr ||
+                 index.getMenuPage("N199/") != nullptr);
+  return mismatches;
+}
+
+void benchIndex() {
+  static BenchIndexTree tree;
+  TeenyMenuIndex index;
+  int mismatches = !index.build(tree.root);
+  std::vector<std::string> paths;
+  std::vector<TeenyMenuPage*> onPath;
+  benchIndexPaths(tree, &tree.root, "", onPath, paths);
+  mismatches += (index.getItemsCount() != paths.size());
+  for (const std::string& path : paths) {
+    TeenyMenuItem* item = index.getMenuItem(path.c_str());
+    mismatches += (item == nullptr || item != benchIndexWalk(tree, path.c_str()));
+    mismatches += (index.getMenuPage((path + "/").c_str()) != tree.linkedPage(item));
+  }
+  static const char* misses[] = { "Group0/Nope", "Group0/Value1/", "Group9/Value1", "Group0//Value1", "Group0/Value1x",
+                                  "Value1", "/Group0", "Group0/Detail/Home/Group1/Value1", "Shared/Common0", "Group0/" };
+  for (const char* path : misses) {
+    mismatches += (index.getMenuItem(path) != nullptr);
+  }
+  mismatches += (index.getMenuPage("") != &tree.root || index.getMenuPage("Group2") != tree.pages[4] ||
+                 index.getMenuPage("Group2/Value1") != nullptr || index.getMenuPage("Nope/") != nullptr);
+  printf("index: %u paths, %d mismatches; lookup %.1f ns by index, %.1f ns walking the pages\n",
+         (unsigned)paths.size(), mismatches,
+         nsPerLookup(paths, [&](const char* path) { return index.getMenuItem(path); }),
+         nsPerLookup(paths, [&](const char* path) { return benchIndexWalk(tree, path); }));
+
+  // navigateTo(): the page and item of the path, drawn once as drawMenu() draws it, Back going up the path
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display);
+  menu.setFrameBuffer(display.getBuffer());
+  menu.setPartialRedraw(true);
+  menu.setMenuPageCurrent(tree.root);
+  menu.drawMenu();
+  uint8_t frame[128 * 64 / 8];
+  int navMismatches = 0;
+  int draws = 0;
+  int jumps = 0;
+  double totalUs = 0;
+  for (size_t p=0; p<paths.size(); p+=3) {
+    std::string path = paths[p];
+    TeenyMenuItem* item = index.getMenuItem(path.c_str());
+    bool toPage = (p % 2 == 1 && tree.linkedPage(item) != nullptr);
+    if (toPage) path += "/";
+    uint32_t displays = display.counters.display;
+    auto start = std::chrono::steady_clock::now();
+    navMismatches += !menu.navigateTo(index, path.c_str());
+    totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    jumps++;
+    draws += display.counters.display - displays;
+    TeenyMenuPage* page = menu.getNavigation().page;
+    if (toPage) {
+      navMismatches += (page != tree.linkedPage(item));
+    } else {
+      navMismatches += (item->getReadonly() ? page->getMenuItem(menu.getCurrentItemNum())->getReadonly()
+                                            : page->getMenuItem(menu.getCurrentItemNum()) != item);
+    }
+    memcpy(frame, display.getBuffer(), sizeof(frame));
+    menu.drawMenu();
+    navMismatches += (memcmp(frame, display.getBuffer(), sizeof(frame)) != 0);
+    // As many levels up as there are '/' in the path
+    int levels = 0;
+    for (char c : path) levels += (c == '/');
+    // Back focuses the link items of the path, the last one first
+    size_t slash = path.size();
+    for (int i=0; i<levels; i++) {
+      navMismatches += (menu.getNavigation().depth + menu.getNavigation().depthBeyond != levels - i);
+      menu.registerKeyPress(TEENYMENU_KEY_LEFT);
+      slash = path.rfind('/', slash - 1);
+      TeenyMenuItem* link = benchIndexWalk(tree, path.substr(0, slash).c_str());
+      navMismatches += (menu.getNavigation().page->getMenuItem(menu.getCurrentItemNum()) != link);
+    }
+    navMismatches += !menu.isMenuPageCurrent(tree.root) || menu.getNavigation().depth + menu.getNavigation().depthBeyond != 0;
+  }
+  navMismatches += menu.navigateTo(index, "Group0/Nope") || menu.navigateTo(index, "Group0/Value1/");
+
+  // set()/get(): values within range, options of selects; out of range, readonly and non-value items refused
+  int setMismatches = 0;
+  uint32_t state = 9;
+  int saves = benchIndexSaves;
+  int accepted = 0;
+  for (const std::string& path : paths) {
+    TeenyMenuItem* item = index.getMenuItem(path.c_str());
+    state = state * 1103515245 + 12345;
+    int32_t value = (int32_t)((state >> 8) % 2400) - 1200;
+    bool isSelect = (path.find("Value3") != std::string::npos || path.find("Value13") != std::string::npos) &&
+                    path.find("Detail") == std::string::npos;
+    bool isFlag = (path.find("Value4") != std::string::npos || path.find("Value14") != std::string::npos) &&
+                  path.find("Detail") == std::string::npos;
+    if (isSelect) value = benchIndexOptions[(state >> 8) % 3].val_int + ((state >> 12) % 2);
+    if (isFlag) value = (state >> 8) % 2;
+    bool valueItem = (tree.linkedPage(item) == nullptr && strcmp(item->getTitle(), "Home") != 0);
+    bool expected = valueItem && !item->getReadonly() &&
+                    (isFlag || (isSelect ? (value == 1 || value == 5 || value == 9) : (value >= -1000 && value <= 1000)));
+    bool set = index.set(path.c_str(), value);
+    int32_t got = 0;
+    bool gotValue = index.get(path.c_str(), got);
+    setMismatches += (set != expected || gotValue != valueItem || (set && got != value));
+    accepted += set;
+  }
+  printf("index: navigateTo %.2f us, %.2f frames per jump, %d mismatches; %d values set, %d saves, %d mismatches\n",
+         totalUs / jumps, (double)draws / jumps, navMismatches, accepted, benchIndexSaves - saves, setMismatches);
+  printf("index: tree over the path limit %d mismatches\n\n", benchIndexCapped());
+}
@@ -0,0 +1,804 @@
+/*
+bench_main.cpp - Host latency benchmark for TeenyMenu (env:native).
+
+Prints, in this order:
+- the memory footprint of the menu objects, then the formatter and text blitter
+  microbenchmarks (bench_prtval.cpp, bench_blit.cpp), the EEPROM writes of
+  TeenyMenuStore (bench_store.cpp), the commands of TeenyMenuRemote against a
+  headless menu (bench_remote.cpp), path lookups through TeenyMenuIndex
+  (bench_index.cpp) and the edits of TeenyMenuValue items (bench_value.cpp)
+- per key press of scripted and random key sequences on pages of various sizes
+  against MockDisplay: wall time, the display calls and characters it caused, and
+  how many key presses (or processKeys() calls) rendered more than one frame
+- the bytes per key press a frame bus sending only changed spans (MockBus)
+  transfers against whole frames, checking after every key press that the
+  emulated display matches the frame buffer, with frames sent at once or in
+  chunks by service() between key presses
+- with TEENYMENU_STATS, the menu's own counters and timings
+- refreshValues() timed with stable and changing linked variables, its frames
+  compared with frames drawn whole by drawMenu() and with frames drawn without
+  the formatted values kept per row
+- a virtual page of benchVirtualRows rows scrolled through by screens and by rows
+  (setRowScroll()), with rows aligned to display pages or not, checking that only
+  the rows on screen are asked for and that partially redrawn frames match
+  frames drawn whole; then item pages scrolled by rows with changing values, also
+  on a display wider than 256 pixels
+- a second menu browsing the pages of a menu, which must draw the same frames as
+  alone, and a third menu mirroring it through a shared TeenyMenuNav
+- a constant page (TEENYMENU_CONST items) browsed, with items hidden and shown
+  by index, against the same page of runtime items
+- pages entered deeper than TEENYMENU_NAV_DEPTH, by navigateTo() and by Right,
+  and Back up to the root page; then page key actions moving the menu
+- items given range variables and edit steps built over and over without
+  allocating, and edited up to their range ends
+
+  pio run -e native && .pio/build/native/program
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include "MockDisplay.h"
+#include "MockBus.h"
+#include "TeenyMenu.h"
+
+void benchPrtVal();  // bench_prtval.cpp
+void benchBlit();    // bench_blit.cpp
+void benchStore();   // bench_store.cpp
+void benchRemote();  // bench_remote.cpp
+void benchIndex();   // bench_index.cpp
+void benchValue();   // bench_value.cpp
+extern unsigned long benchNewAllocations;  // bench_prtval.cpp
+
+// Page sizes to benchmark (TeenyMenuPage counts items in a byte, so 255 is the largest page)
+static const int benchPageSizes[] = { 10, 50, 100, 250 };
+
+static const int benchKeysPerRun = 2000;
+
+// Keys queued per processKeys() call in the queued runs (an encoder spin between two loop() passes)
+static const int benchBurstLength = 8;
+
+/********************************************************************/
+// Menu under test
+/********************************************************************/
+struct BenchMenu {
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu;
+  TeenyMenuPage mainPage;
+  TeenyMenuPage subPage;
+  TeenyMenuItem* items;
+  int itemsCount;
+  int* values;
+  int selectValue;
+  boolean flag;
+  int rangeMin;
+  int rangeMax;
+  TeenyMenuRange range;
+
+  BenchMenu(int itemsCount_, int16_t width_ = 128)
+    : display(width_)
+    , menu(display)
+    , mainPage("BENCH")
+    , subPage("SUB")
+    , itemsCount(itemsCount_)
+    , selectValue(20)
+    , flag(false)
+    , rangeMin(-1000)
+    , rangeMax(1000)
+    , range{&rangeMin, &rangeMax, nullptr, 0}
+  {
+    values = new int[itemsCount]();
+    // Items are constructed in place, in one block, so they are addressable by index
+    items = (TeenyMenuItem*)::operator new(sizeof(TeenyMenuItem) * (itemsCount + 2));
+    TeenyMenuItem** menuItems = new TeenyMenuItem*[itemsCount];
+    for (int i=0; i<itemsCount; i++) {
+      switch (i % 8) {
+        case 3:
+          new (&items[i]) TeenyMenuItem("Select", selectValue, benchSelect());
+          break;
+        case 5:
+          new (&items[i]) TeenyMenuItem("Flag", flag);
+          break;
+        case 6:
+          new (&items[i]) TeenyMenuItem("Label");
+          break;
+        case 7:
+          new (&items[i]) TeenyMenuItem("Sub page", subPage);
+          break;
+        default:
+          new (&items[i]) TeenyMenuItem("Value", values[i], range);
+          break;
+      }
+      menuItems[i] = &items[i];
+    }
+    mainPage.addMenuItems(menuItems, itemsCount);
+    delete[] menuItems;
+    new (&items[itemsCount]) TeenyMenuItem();
+    new (&items[itemsCount+1]) TeenyMenuItem("Sub value", values[0]);
+    subPage.addMenuItem(items[itemsCount]);
+    subPage.addMenuItem(items[itemsCount+1]);
+    menu.setMenuPageCurrent(mainPage);
+    menu.drawMenu();
+  }
+
+  ~BenchMenu() {
+    for (int i=0; i<itemsCount+2; i++) {
+      items[i].~TeenyMenuItem();
+    }
+    ::operator delete(items);
+    delete[] values;
+  }
+
+  static SelectOptionInt* benchSelectOptions() {
+    static SelectOptionInt options[64];
+    static char names[64][8];
+    for (int i=0; i<64; i++) {
+      snprintf(names[i], sizeof(names[i]), "CH%d", i);
+      options[i].name = names[i];
+      options[i].val_int = i * 5;
+    }
+    return options;
+  }
+
+  static TeenyMenuSelect& benchSelect() {
+    static TeenyMenuSelect select(64, benchSelectOptions());
+    return select;
+  }
+};
+
+// Data bytes sent per TeenyMenu::service() call in the "async" runs
+static const int benchBusChunk = 64;
+
+// Bus the menu sends frames to in the "bus" runs (setFrameBus() takes plain function pointers)
+static MockBus* benchBus = nullptr;
+
+static void benchBusCommand(const uint8_t* bytes, uint16_t count) {
+  benchBus->command(bytes, count);
+}
+
+static void benchBusData(const uint8_t* bytes, uint16_t count) {
+  benchBus->data(bytes, count);
+}
+
+/********************************************************************/
+// Key sequences
+/********************************************************************/
+typedef byte (*KeyGenerator)(int step, uint32_t& state);
+
+// Scroll down and back up in runs of 512 keys, editing the focused item every 64 keys
+static byte scriptedKey(int step, uint32_t&) {
+  static const byte edit[] = { TEENYMENU_KEY_RIGHT, TEENYMENU_KEY_UP, TEENYMENU_KEY_UP, TEENYMENU_KEY_DOWN, TEENYMENU_KEY_RIGHT };
+  int phase = step % 64;
+  if (phase >= 59) {
+    return edit[phase - 59];
+  }
+  return ((step / 512) % 2 == 0) ? TEENYMENU_KEY_DOWN : TEENYMENU_KEY_UP;
+}
+
+// Uniformly random keys from a fixed-seed LCG, so runs are reproducible
+static byte randomKey(int, uint32_t& state) {
+  state = state * 1103515245 + 12345;
+  return 1 + (state >> 16) % 4;
+}
+
+/********************************************************************/
+// Runner
+/********************************************************************/
+struct BenchResult {
+  double avgUs;
+  double maxUs;
+  double printPerKey;
+  double drawRectPerKey;
+  double displayPerKey;
+  double charsPerKey;
+  int multipleRenders;        // Key presses (processKeys() calls if queued) that called display() more than once
+  double busBytesPerKey;
+  double busWritesPerKey;
+  int busMismatches;          // Key presses after which the emulated display differed from the frame buffer
+#ifdef TEENYMENU_STATS
+  TeenyMenuStats stats;
+#endif
+};
+
+// redraw: 0 - full, 1 - partial, 2 - partial with text blitted into the frame buffer,
+// 3 - as 2 with changed spans of the frame sent over MockBus,
+// 4 - as 3 with frames sent by one service() call after each key press
+// With queued=false every key goes through registerKeyPress(), otherwise keys are queued
+// in bursts of benchBurstLength and handled by processKeys()
+static BenchResult runBench(int pageSize, KeyGenerator keyGenerator, int redraw, bool queued) {
+  BenchMenu bench(pageSize);
+  bench.menu.setPartialRedraw(redraw > 0);
+  if (redraw >= 2) {
+    bench.menu.setFrameBuffer(bench.display.getBuffer());
+  }
+  MockBus bus;
+  static uint8_t shadow[128 * 64 / 8];
+  static uint8_t front[128 * 64 / 8];
+  if (redraw >= 3) {
+    benchBus = &bus;
+    bench.menu.setFrameBus(shadow, benchBusCommand, benchBusData);
+    if (redraw == 4) {
+      bench.menu.setFrameBusAsync(front, benchBusChunk);
+    }
+    bench.menu.drawMenu();
+    while (bench.menu.service());
+  }
+  bench.display.resetCounters();
+  bus.resetCounters();
+#ifdef TEENYMENU_STATS
+  bench.menu.resetStats();
+#endif
+  int busMismatches = 0;
+  int multipleRenders = 0;
+  uint32_t displayCalls = 0;
+  uint32_t state = 1;
+  double totalUs = 0;
+  double maxUs = 0;
+  for (int step=0; step<benchKeysPerRun; step++) {
+    byte key = keyGenerator(step, state);
+    auto start = std::chrono::steady_clock::now();
+    if (!queued) {
+      bench.menu.registerKeyPress(key);
+    } else {
+      bench.menu.queueKeyPress(key);
+      if ((step+1) % benchBurstLength == 0) {
+        bench.menu.processKeys();
+      }
+    }
+    if (redraw == 4) {
+      bench.menu.service();
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    totalUs += us;
+    if (us > maxUs) maxUs = us;
+    if (!queued || (step+1) % benchBurstLength == 0) {
+      multipleRenders += (bench.display.counters.display - displayCalls > 1);
+      displayCalls = bench.display.counters.display;
+    }
+    if ((redraw == 3 && (!queued || (step+1) % benchBurstLength == 0)) ||
+        (redraw == 4 && !bench.menu.isFlushBusy())) {
+      busMismatches += (memcmp(bus.ram(), bench.display.getBuffer(), bus.ramSize()) != 0);
+    }
+  }
+  if (redraw == 4) {
+    while (bench.menu.service());
+    busMismatches += (memcmp(bus.ram(), bench.display.getBuffer(), bus.ramSize()) != 0);
+  }
+  const MockDisplayCounters& counters = bench.display.counters;
+  BenchResult result;
+  result.avgUs = totalUs / benchKeysPerRun;
+  result.maxUs = maxUs;
+  result.printPerKey = (double)counters.print / benchKeysPerRun;
+  result.drawRectPerKey = (double)counters.drawRect / benchKeysPerRun;
+  result.displayPerKey = (double)counters.display / benchKeysPerRun;
+  result.charsPerKey = (double)counters.chars / benchKeysPerRun;
+  result.multipleRenders = multipleRenders;
+  result.busBytesPerKey = (double)(bus.counters.commandBytes + bus.counters.dataBytes) / benchKeysPerRun;
+  result.busWritesPerKey = (double)(bus.counters.commandWrites + bus.counters.dataWrites) / benchKeysPerRun;
+  result.busMismatches = busMismatches;
+#ifdef TEENYMENU_STATS
+  result.stats = bench.menu.getStats();
+#endif
+  benchBus = nullptr;
+  return result;
+}
+
+// refreshValues() called with unchanged variables, then after changing one visible value each time
+static void benchRefresh() {
+  BenchMenu bench(benchPageSizes[1]);
+  bench.menu.setFrameBuffer(bench.display.getBuffer());
+  bench.menu.drawMenu();
+  static const int calls = 20000;
+  bench.display.resetCounters();
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<calls; i++) {
+    bench.menu.refreshValues();
+  }
+  double stableNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+  double stableDisplay = (double)bench.display.counters.display / calls;
+  // Items 0, 1 and 2 of the page are values (see BenchMenu)
+  bench.display.resetCounters();
+  start = std::chrono::steady_clock::now();
+  for (int i=0; i<calls; i++) {
+    bench.values[i % 3] += 7;
+    bench.menu.refreshValues();
+  }
+  double changingNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+  double changingDisplay = (double)bench.display.counters.display / calls;
+  static uint8_t refreshed[128 * 64 / 8];
+  int mismatches = 0;
+  int cacheMismatches = 0;
+  // Drawing another page first drops the formatted values the menu keeps per row
+  BenchMenu uncached(benchPageSizes[1]);
+  uncached.menu.setFrameBuffer(uncached.display.getBuffer());
+  for (int i=0; i<100; i++) {
+    bench.values[i % 3] = (i * 7919) % 2000 - 1000;
+    bench.flag = !bench.flag;
+    bench.selectValue = (i % 64) * 5;
+    bench.menu.refreshValues();
+    memcpy(refreshed, bench.display.getBuffer(), sizeof(refreshed));
+    bench.menu.drawMenu();
+    mismatches += (memcmp(refreshed, bench.display.getBuffer(), sizeof(refreshed)) != 0);
+    memcpy(uncached.values, bench.values, sizeof(int) * 3);
+    uncached.flag = bench.flag;
+    uncached.selectValue = bench.selectValue;
+    uncached.menu.setMenuPageCurrent(uncached.subPage);
+    uncached.menu.drawMenu();
+    uncached.menu.setMenuPageCurrent(uncached.mainPage);
+    uncached.menu.drawMenu();
+    cacheMismatches += (memcmp(uncached.display.getBuffer(), bench.display.getBuffer(), sizeof(refreshed)) != 0);
+  }
+  printf("refreshValues: stable %.1f ns and %.2f display() per call, changing %.1f ns and %.2f display() per call\n",
+         stableNs, stableDisplay, changingNs, changingDisplay);
+  printf("refreshValues: %d mismatches against drawMenu(), drawMenu(): %d mismatches against uncached values\n",
+         mismatches, cacheMismatches);
+}
+
+// Rows of the virtual page (TeenyMenuRows) and row texts asked for by the menu
+static const teenyMenu_row_t benchVirtualRows = 10000;
+static uint32_t benchVirtualTexts = 0;
+static teenyMenu_row_t benchVirtualSelected = 0;
+
+static teenyMenu_row_t benchVirtualCount() {
+  return benchVirtualRows;
+}
+
+static void benchVirtualText(teenyMenu_row_t index, char* buf, byte len) {
+  benchVirtualTexts++;
+  snprintf(buf, len + 1, "Event %u", (unsigned)index);
+}
+
+static void benchVirtualSelect(teenyMenu_row_t index) {
+  benchVirtualSelected = index;
+}
+
+// Scroll a virtual page down through all of its rows and back, partially redrawn into the frame buffer
+// aligned: rows 8 pixels high from the second display page on, otherwise the default layout
+static void benchVirtual(bool rowScroll, bool aligned) {
+  static const TeenyMenuRows rows = { benchVirtualCount, benchVirtualText, benchVirtualSelect };
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display, aligned ? 8 : 10, aligned ? 8 : 9, aligned ? 7 : 6);
+  TeenyMenuPage page("LOG", rows);
+  menu.setFrameBuffer(display.getBuffer());
+  menu.setPartialRedraw(true);
+  menu.setRowScroll(rowScroll);
+  menu.setMenuPageCurrent(page);
+  menu.drawMenu();
+  static uint8_t redrawn[128 * 64 / 8];
+  int mismatches = 0;
+  int positionErrors = 0;
+  uint32_t keys = 0;
+  benchVirtualTexts = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i=1; i<=benchVirtualRows; i++, keys++) {
+    menu.registerKeyPress(TEENYMENU_KEY_DOWN);
+    positionErrors += (menu.getCurrentItemNum() != i % benchVirtualRows);
+  }
+  menu.registerKeyPress(TEENYMENU_KEY_UP);
+  keys++;
+  double keyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / keys;
+  double textsPerKey = (double)benchVirtualTexts / keys;
+  positionErrors += (menu.getCurrentItemNum() != benchVirtualRows - 1);
+  menu.registerKeyPress(TEENYMENU_KEY_RIGHT);
+  positionErrors += (benchVirtualSelected != benchVirtualRows - 1);
+  for (uint32_t i=0; i<500; i++) {
+    menu.registerKeyPress((i % 7 < 4) ? TEENYMENU_KEY_UP : TEENYMENU_KEY_DOWN);
+    memcpy(redrawn, display.getBuffer(), sizeof(redrawn));
+    benchVirtualTexts = 0;
+    menu.drawMenu();
+    mismatches += (memcmp(redrawn, display.getBuffer(), sizeof(redrawn)) != 0);
+    mismatches += (benchVirtualTexts > (aligned ? 7u : 6u));
+  }
+  printf("virtual page: %u rows in a %u byte page, %-7s %-9s %.2f row texts and %.2f us per key, %d position errors, %d mismatches against drawMenu()\n",
+         (unsigned)benchVirtualRows, (unsigned)sizeof(TeenyMenuPage), rowScroll ? "rows" : "screens", aligned ? "aligned" : "unaligned",
+         textsPerKey, keyUs, positionErrors, mismatches);
+}
+
+// Item page scrolled by rows, partially redrawn into the frame buffer, with visible values changing
+// and refreshed between key presses; frames are compared with frames drawn whole after each key press,
+// and refreshValues() right after a key press must find nothing to redraw (values moved with their rows)
+// 'width' - display width, wider than 256 pixels checks that rows are cleared across the whole display
+static void benchRowScroll(KeyGenerator keyGenerator, const char* name, int16_t width = 128) {
+  BenchMenu bench(benchPageSizes[2], width);
+  bench.menu.setFrameBuffer(bench.display.getBuffer());
+  bench.menu.setPartialRedraw(true);
+  bench.menu.setRowScroll(true);
+  bench.menu.drawMenu();
+  static uint8_t redrawn[320 * 64 / 8];
+  size_t frameLength = width * 64 / 8;
+  int mismatches = 0;
+  int refreshed = 0;
+  uint32_t state = 1;
+  double totalUs = 0;
+  for (int step=0; step<benchKeysPerRun; step++) {
+    auto start = std::chrono::steady_clock::now();
+    bench.menu.registerKeyPress(keyGenerator(step, state));
+    totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    refreshed += bench.menu.refreshValues();
+    bench.values[(step * 5) % bench.itemsCount] += 3;
+    bench.menu.refreshValues();
+    memcpy(redrawn, bench.display.getBuffer(), frameLength);
+    bench.menu.drawMenu();
+    mismatches += (memcmp(redrawn, bench.display.getBuffer(), frameLength) != 0);
+  }
+  printf("row scroll: %-8s %d items, %d pixels wide, %.2f us per key, %d values refreshed after key presses, %d mismatches against drawMenu()\n",
+         name, benchPageSizes[2], width, totalUs / benchKeysPerRun, refreshed, mismatches);
+}
+
+// Two menus browsing the same pages must not move each other, a menu sharing the navigation state of another
+// (TeenyMenuNav) must draw the same frames once synced
+static void benchNavigation() {
+  BenchMenu shared(benchPageSizes[1]);
+  BenchMenu alone(benchPageSizes[1]);
+  MockDisplay otherDisplay;
+  TeenyMenu<MockDisplay> other(otherDisplay);
+  MockDisplay mirrorDisplay;
+  TeenyMenu<MockDisplay> mirror(mirrorDisplay);
+  shared.menu.setFrameBuffer(shared.display.getBuffer());
+  shared.menu.setPartialRedraw(true);
+  alone.menu.setFrameBuffer(alone.display.getBuffer());
+  alone.menu.setPartialRedraw(true);
+  other.setFrameBuffer(otherDisplay.getBuffer());
+  other.setMenuPageCurrent(shared.mainPage);
+  other.drawMenu();
+  mirror.setFrameBuffer(mirrorDisplay.getBuffer());
+  mirror.setNavigation(shared.menu.getNavigation());
+  int independentMismatches = 0;
+  int mirrorMismatches = 0;
+  int syncs = 0;
+  uint32_t state = 1;
+  uint32_t otherState = 7;
+  for (int step=0; step<benchKeysPerRun; step++) {
+    byte key = scriptedKey(step, state);
+    shared.menu.registerKeyPress(key);
+    alone.menu.registerKeyPress(key);
+    independentMismatches += (memcmp(shared.display.getBuffer(), alone.display.getBuffer(), 128 * 64 / 8) != 0);
+    syncs += mirror.syncNavigation();
+    mirrorMismatches += (memcmp(shared.display.getBuffer(), mirrorDisplay.getBuffer(), 128 * 64 / 8) != 0);
+    // The other menu only moves around and goes in and out of the sub page, so that linked variables stay as they are
+    otherState = otherState * 1103515245 + 12345;
+    byte otherKey = ((otherState >> 16) & 1) ? TEENYMENU_KEY_DOWN : TEENYMENU_KEY_UP;
+    if (other.isMenuPageCurrent(shared.subPage)) {
+      if ((otherState >> 17) % 4 == 0) {
+        otherKey = TEENYMENU_KEY_LEFT;
+      }
+    } else if (other.getCurrentItemNum() % 8 == 7) {
+      otherKey = TEENYMENU_KEY_RIGHT;
+    }
+    other.registerKeyPress(otherKey);
+  }
+  // Entering the sub page from the main page must not have set its parent
+  independentMismatches += (shared.subPage.getParentMenuPage() != nullptr);
+  printf("navigation: %d mismatches with another menu on the same pages, %d mismatches of a mirror synced %d times\n",
+         independentMismatches, mirrorMismatches, syncs);
+}
+
+// Constant page: items and item array declared TEENYMENU_CONST constexpr, linked to one set of variables
+struct BenchConstVars {
+  int values[6];
+  boolean flag;
+  byte level;
+};
+static BenchConstVars benchConstVars = { { 1, 2, 3, 4, 5, 6 }, false, 9 };
+static BenchConstVars benchRuntimeVars = benchConstVars;
+static int benchConstMin = -20;
+static int benchConstMax = 20;
+static int benchConstPresses = 0;
+static TeenyMenuPage benchConstSub("SUB");
+
+static void benchConstPress() {
+  benchConstPresses++;
+}
+
+TEENYMENU_CONST constexpr TeenyMenuRange benchConstRange{&benchConstMin, &benchConstMax, nullptr, 0};
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstValue0("Value A", benchConstVars.values[0], benchConstRange);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstValue1("Value B", benchConstVars.values[1], benchConstRange);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstFlag("Flag", benchConstVars.flag);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstLabel("Label");
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstLevel("Level", benchConstVars.level);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstLink("Sub page", benchConstSub);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstValue2("Value C", benchConstVars.values[2], benchConstRange);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstButton("Button", benchConstPress);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstValue3("Value D", benchConstVars.values[3]);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstReadonly("Readonly", benchConstVars.values[4], TEENYMENU_READONLY);
+TEENYMENU_CONST constexpr TeenyMenuItem benchConstValue5("Value F", benchConstVars.values[5], benchConstRange);
+TEENYMENU_CONST constexpr const TeenyMenuItem* benchConstItems[] = {
+  &benchConstValue0, &benchConstValue1, &benchConstFlag, &benchConstLabel, &benchConstLevel, &benchConstLink,
+  &benchConstValue2, &benchConstButton, &benchConstValue3, &benchConstReadonly, &benchConstValue5
+};
+static const int benchConstCount = sizeof(benchConstItems) / sizeof(benchConstItems[0]);
+
+// A constant page and the same page of runtime items, browsed by two menus with the same keys and with the same
+// items hidden and shown by index, must draw the same frames and index their items alike; items can't be added to
+// the constant page
+static void benchConstPage() {
+  TeenyMenuItem runtimeItems[] = {
+    TeenyMenuItem("Value A", benchRuntimeVars.values[0], benchConstRange),
+    TeenyMenuItem("Value B", benchRuntimeVars.values[1], benchConstRange),
+    TeenyMenuItem("Flag", benchRuntimeVars.flag),
+    TeenyMenuItem("Label"),
+    TeenyMenuItem("Level", benchRuntimeVars.level),
+    TeenyMenuItem("Sub page", benchConstSub),
+    TeenyMenuItem("Value C", benchRuntimeVars.values[2], benchConstRange),
+    TeenyMenuItem("Button", benchConstPress),
+    TeenyMenuItem("Value D", benchRuntimeVars.values[3]),
+    TeenyMenuItem("Readonly", benchRuntimeVars.values[4], TEENYMENU_READONLY),
+    TeenyMenuItem("Value F", benchRuntimeVars.values[5], benchConstRange),
+  };
+  TeenyMenuItem* runtimeItemPointers[benchConstCount];
+  for (int i=0; i<benchConstCount; i++) {
+    runtimeItemPointers[i] = &runtimeItems[i];
+  }
+  TeenyMenuPage constPage("CONST", benchConstItems);
+  TeenyMenuPage runtimePage("CONST");
+  runtimePage.addMenuItems(runtimeItemPointers, benchConstCount);
+  TeenyMenuItem subBack;
+  TeenyMenuItem subValue("Sub value", benchConstMax);
+  benchConstSub.addMenuItem(subBack);
+  benchConstSub.addMenuItem(subValue);
+  // Adding to a constant page is refused, the page is left as it was
+  TeenyMenuItem extra("Extra", benchConstMin);
+  TeenyMenuItem* extraPointers[] = { &extra };
+  constPage.addMenuItem(extra);
+  constPage.addMenuItems(extraPointers, 1);
+  int mismatches = (constPage.getRowsCount() != benchConstCount) + (constPage.getMenuItemIndexTotal(extra) != -1) +
+                   (constPage.getMenuItem(benchConstCount, true) != nullptr);
+
+  MockDisplay constDisplay;
+  TeenyMenu<MockDisplay> constMenu(constDisplay);
+  MockDisplay runtimeDisplay;
+  TeenyMenu<MockDisplay> runtimeMenu(runtimeDisplay);
+  constMenu.setFrameBuffer(constDisplay.getBuffer());
+  constMenu.setPartialRedraw(true);
+  constMenu.setMenuPageCurrent(constPage);
+  constMenu.drawMenu();
+  runtimeMenu.setFrameBuffer(runtimeDisplay.getBuffer());
+  runtimeMenu.setPartialRedraw(true);
+  runtimeMenu.setMenuPageCurrent(runtimePage);
+  runtimeMenu.drawMenu();
+  int toggles = 0;
+  uint32_t state = 3;
+  for (int step=0; step<benchKeysPerRun; step++) {
+    if (step % 16 == 15) {
+      // Hide or show an item, the first toggle builds the visibility index of the constant page with all items visible
+      state = state * 1103515245 + 12345;
+      byte index = (state >> 16) % benchConstCount;
+      boolean hide = !constPage.isMenuItemHidden(index);
+      constPage.hideMenuItem(index, hide);
+      runtimePage.hideMenuItem(index, hide);
+      toggles++;
+      mismatches += (constPage.isMenuItemHidden(index) != hide) + (runtimePage.isMenuItemHidden(index) != hide) +
+                    (constPage.getRowsCount() != runtimePage.getRowsCount());
+      for (int i=0; i<benchConstCount; i++) {
+        mismatches += (constPage.getMenuItemIndexTotal(*benchConstItems[i]) != i) +
+                      (constPage.getMenuItemNum(*benchConstItems[i]) != runtimePage.getMenuItemNum(runtimeItems[i])) +
+                      (runtimeItems[i].isHidden() != constPage.isMenuItemHidden(i));
+      }
+      constMenu.drawMenu();
+      runtimeMenu.drawMenu();
+    }
+    byte key = randomKey(step, state);
+    constMenu.registerKeyPress(key);
+    runtimeMenu.registerKeyPress(key);
+    mismatches += (memcmp(constDisplay.getBuffer(), runtimeDisplay.getBuffer(), 128 * 64 / 8) != 0);
+  }
+  mismatches += (memcmp(&benchConstVars, &benchRuntimeVars, sizeof(BenchConstVars)) != 0) + (benchConstPresses % 2 != 0);
+  printf("const page: %d items, %d keys, %d items hidden or shown, %d mismatches against runtime page\n",
+         benchConstCount, benchKeysPerRun, toggles, mismatches);
+}
+
+// Pages entered deeper than the breadcrumb holds (TEENYMENU_NAV_DEPTH), by navigateTo() and then by Right: Back must
+// go up through every page to the root page, focusing the link item on the pages the breadcrumb kept
+static const int benchDeepLevels = TEENYMENU_NAV_DEPTH * 2 + 3;
+static int benchDeepValue = 0;
+
+static int benchDeepBack(TeenyMenu<MockDisplay>& menu, TeenyMenuPage** pages) {
+  int mismatches = 0;
+  for (int i=benchDeepLevels-1; i>=0; i--) {
+    menu.registerKeyPress(TEENYMENU_KEY_LEFT);
+    mismatches += !menu.isMenuPageCurrent(*pages[i]) || menu.getCurrentItemNum() != ((i < TEENYMENU_NAV_DEPTH) ? 1 : 0);
+  }
+  return mismatches + menu.exitToParentMenuPage();
+}
+
+// Key actions of a page moving the menu: Down past the last item going to another page must leave that page with its
+// default item focused, Up past the first item resetting the page must leave the default item focused
+static TeenyMenu<MockDisplay>* benchEdgeMenu = nullptr;
+static TeenyMenuPage* benchEdgeOther = nullptr;
+
+static void benchEdgeDown() {
+  benchEdgeMenu->setMenuPageCurrent(*benchEdgeOther);
+}
+
+static void benchEdgeUp() {
+  benchEdgeMenu->resetMenu();
+}
+
+static void benchNavigationEdges() {
+  TeenyMenuPage* pages[benchDeepLevels + 1];
+  TeenyMenuItem* items[benchDeepLevels * 2 + 1];
+  for (int i=0; i<=benchDeepLevels; i++) {
+    pages[i] = new TeenyMenuPage("DEEP");
+    items[i] = new TeenyMenuItem("Value", benchDeepValue);
+    pages[i]->addMenuItem(*items[i]);
+  }
+  std::string path;
+  for (int i=0; i<benchDeepLevels; i++) {
+    items[benchDeepLevels + 1 + i] = new TeenyMenuItem("Deeper", *pages[i+1]);
+    pages[i]->addMenuItem(*items[benchDeepLevels + 1 + i]);
+    path += "Deeper/";
+  }
+  path += "Value";
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display);
+  menu.setMenuPageCurrent(*pages[0]);
+  menu.drawMenu();
+  TeenyMenuIndex index;
+  int deepMismatches = !index.build(*pages[0]) || !menu.navigateTo(index, path.c_str()) ||
+                       !menu.isMenuPageCurrent(*pages[benchDeepLevels]);
+  deepMismatches += benchDeepBack(menu, pages);
+  // Back left the link item focused
+  menu.resetMenu();
+  for (int i=0; i<benchDeepLevels; i++) {
+    menu.registerKeyPress(TEENYMENU_KEY_DOWN);
+    menu.registerKeyPress(TEENYMENU_KEY_RIGHT);
+    deepMismatches += !menu.isMenuPageCurrent(*pages[i+1]);
+  }
+  deepMismatches += benchDeepBack(menu, pages);
+  for (int i=0; i<=benchDeepLevels; i++) {
+    delete pages[i];
+  }
+  for (TeenyMenuItem* item : items) {
+    delete item;
+  }
+
+  TeenyMenuPage edgePage("EDGE", nullptr, nullptr, benchEdgeUp, benchEdgeDown);
+  TeenyMenuPage otherPage("OTHER");
+  TeenyMenuItem edgeBack;
+  TeenyMenuItem edgeValues[] = { TeenyMenuItem("Value A", benchDeepValue), TeenyMenuItem("Value B", benchDeepValue),
+                                 TeenyMenuItem("Value C", benchDeepValue) };
+  TeenyMenuItem otherValues[] = { TeenyMenuItem("Value A", benchDeepValue), TeenyMenuItem("Value B", benchDeepValue),
+                                  TeenyMenuItem("Value C", benchDeepValue), TeenyMenuItem("Value D", benchDeepValue) };
+  edgePage.addMenuItem(edgeBack);
+  for (TeenyMenuItem& item : edgeValues) {
+    edgePage.addMenuItem(item);
+  }
+  for (TeenyMenuItem& item : otherValues) {
+    otherPage.addMenuItem(item);
+  }
+  benchEdgeMenu = &menu;
+  benchEdgeOther = &otherPage;
+  menu.setMenuPageCurrent(edgePage);
+  menu.drawMenu();
+  // Back is focusable, but not the default item
+  menu.registerKeyPress(TEENYMENU_KEY_UP);
+  int edgeMismatches = (menu.getCurrentItemNum() != 0);
+  menu.registerKeyPress(TEENYMENU_KEY_UP);
+  edgeMismatches += !menu.isMenuPageCurrent(edgePage) || menu.getCurrentItemNum() != 1;
+  menu.registerKeyPress(TEENYMENU_KEY_DOWN);
+  menu.registerKeyPress(TEENYMENU_KEY_DOWN);
+  menu.registerKeyPress(TEENYMENU_KEY_DOWN);
+  edgeMismatches += !menu.isMenuPageCurrent(otherPage) || menu.getCurrentItemNum() != 0;
+  benchEdgeMenu = nullptr;
+  printf("navigation edges: %d pages deep, %d mismatches going back; key actions moving the menu, %d mismatches\n",
+         benchDeepLevels, deepMismatches, edgeMismatches);
+}
+
+// Items given range variables rather than a TeenyMenuRange, and edit steps, take their range records from the shared
+// pool: built over and over they allocate nothing nor use the pool up, and editing still stops at the range ends
+static int benchRangeMin = -5;
+static int benchRangeMax = 5;
+static const int32_t benchRangeSteps[] = { 1, 4 };
+
+static void benchRangeItems() {
+  unsigned long allocations = benchNewAllocations;
+  int value = 0;
+  for (int i=0; i<1000; i++) {
+    TeenyMenuItem item("Value", value, benchRangeMin, benchRangeMax);
+    item.setEditSteps(benchRangeSteps, 2);
+  }
+  allocations = benchNewAllocations - allocations;
+  TeenyMenuItem item("Value", value, benchRangeMin, benchRangeMax);
+  item.setEditSteps(benchRangeSteps, 2);
+  TeenyMenuPage page("RANGE");
+  page.addMenuItem(item);
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display);
+  menu.setMenuPageCurrent(page);
+  menu.drawMenu();
+  int mismatches = 0;
+  static const struct { byte key; int presses; int expected; } runs[] = {
+    { TEENYMENU_KEY_UP, 20, 5 }, { TEENYMENU_KEY_DOWN, 3, 2 }, { TEENYMENU_KEY_DOWN, 20, -5 },
+  };
+  for (const auto& run : runs) {
+    menu.registerKeyPress(TEENYMENU_KEY_RIGHT);
+    for (int i=0; i<run.presses; i++) {
+      menu.registerKeyPress(run.key);
+    }
+    menu.registerKeyPress(TEENYMENU_KEY_RIGHT);
+    mismatches += (value != run.expected);
+  }
+  printf("range items: %lu allocations building 1000 items with range variables and edit steps, %d mismatches\n",
+         allocations, mismatches);
+}
+
+int main() {
+  printf("footprint: TeenyMenuItem %u, TeenyMenuValue<int> %u, TeenyMenuRange %u, TeenyMenuPage %u, TeenyMenuSelect %u, TeenyMenuNav %u bytes\n",
+         (unsigned)sizeof(TeenyMenuItem), (unsigned)sizeof(TeenyMenuValue<int>), (unsigned)sizeof(TeenyMenuRange), (unsigned)sizeof(TeenyMenuPage),
+         (unsigned)sizeof(TeenyMenuSelect), (unsigned)sizeof(TeenyMenuNav));
+  printf("footprint: %d-item page %u bytes of items (value items share one range record)\n\n",
+         benchPageSizes[3], (unsigned)(sizeof(TeenyMenuItem) * benchPageSizes[3]));
+  benchPrtVal();
+  benchBlit();
+  benchStore();
+  benchRemote();
+  benchIndex();
+  benchValue();
+  struct { const char* name; KeyGenerator generator; } sequences[] = {
+    { "scripted", scriptedKey },
+    { "random", randomKey },
+  };
+  printf("%-9s %5s %-8s %-7s %9s %9s %8s %9s %8s %8s %9s\n",
+         "sequence", "items", "redraw", "input", "avg us", "max us", "print", "drawRect", "display", "chars", "renders>1");
+  for (auto& sequence : sequences) {
+    for (int pageSize : benchPageSizes) {
+      for (int redraw=0; redraw<3; redraw++) {
+        for (int queued=0; queued<2; queued++) {
+          BenchResult r = runBench(pageSize, sequence.generator, redraw, queued);
+          printf("%-9s %5d %-8s %-7s %9.2f %9.2f %8.2f %9.2f %8.2f %8.1f %9d\n",
+                 sequence.name, pageSize, (redraw == 2) ? "blit" : redraw ? "partial" : "full", queued ? "queued" : "direct",
+                 r.avgUs, r.maxUs, r.printPerKey, r.drawRectPerKey, r.displayPerKey, r.charsPerKey, r.multipleRenders);
+        }
+      }
+    }
+  }
+  // Frames display() sends in the "blit" run, each being the display RAM plus its address window
+  const double frameBytes = 128 * 64 / 8 + 6;
+  printf("\n%-9s %5s %-6s %-7s %9s %9s %12s %12s %11s %10s\n",
+         "sequence", "items", "flush", "input", "avg us", "max us", "frame B/key", "bus B/key", "writes/key", "mismatches");
+  for (auto& sequence : sequences) {
+    for (int pageSize : benchPageSizes) {
+      for (int async=0; async<2; async++) {
+        for (int queued=0; queued<2; queued++) {
+          BenchResult r = runBench(pageSize, sequence.generator, 3 + async, queued);
+          BenchResult frames = runBench(pageSize, sequence.generator, 2, queued);
+          printf("%-9s %5d %-6s %-7s %9.2f %9.2f %12.1f %12.1f %11.2f %10d\n",
+                 sequence.name, pageSize, async ? "async" : "sync", queued ? "queued" : "direct", r.avgUs, r.maxUs,
+                 frames.displayPerKey * frameBytes, r.busBytesPerKey, r.busWritesPerKey, r.busMismatches);
+        }
+      }
+    }
+  }
+#ifdef TEENYMENU_STATS
+  static const char* redrawNames[] = { "full", "partial", "blit", "bus", "async" };
+  printf("\n%-8s %5s %8s %8s %8s %8s %9s %8s %8s %14s %14s %14s\n", "redraw", "items", "drawMenu", "partial", "rows", "chars",
+         "formatted", "cached", "flushes", "render ns", "flush ns", "key-flush ns");
+  for (int redraw=0; redraw<5; redraw++) {
+    BenchResult r = runBench(benchPageSizes[3], scriptedKey, redraw, false);
+    const TeenyMenuStats& st = r.stats;
+    printf("%-8s %5d %8u %8u %8u %8u %9u %8u %8u %6u/%7u %6u/%7u %6u/%7u\n",
+           redrawNames[redraw], benchPageSizes[3], (unsigned)st.drawMenuCalls, (unsigned)st.partialRedraws,
+           (unsigned)st.itemsDrawn, (unsigned)st.charsPrinted, (unsigned)st.valuesFormatted, (unsigned)st.valuesCached,
+           (unsigned)st.flushes,
+           (unsigned)st.render.avg(), (unsigned)st.render.max, (unsigned)st.flush.avg(), (unsigned)st.flush.max,
+           (unsigned)st.keyToFlush.avg(), (unsigned)st.keyToFlush.max);
+  }
+  printf("(avg/max, %d scripted key presses each)\n", benchKeysPerRun);
+#endif
+  printf("\n");
+  benchRefresh();
+  for (int rowScroll=0; rowScroll<2; rowScroll++) {
+    for (int aligned=0; aligned<2; aligned++) {
+      benchVirtual(rowScroll, aligned);
+    }
+  }
+  benchRowScroll(scriptedKey, "scripted");
+  benchRowScroll(randomKey, "random");
+  benchRowScroll(scriptedKey, "scripted", 320);
+  benchNavigation();
+  benchConstPage();
+  benchNavigationEdges();
+  benchRangeItems();
+  return 0;
+}
@@ -0,0 +1,246 @@
+/*
+bench_prtval.cpp - Formatter microbenchmarks for TeenyPrtVal (env:native).
+
+Checks the printf-free prt_int()/prt_uint()/prt_hex()/prt_float()/prt_fixed()
+formatters against snprintf(), times them against the former sprintf() and
+String based versions and counts heap allocations per call.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+#include "TeenyPrtVal.h"
+
+static const int benchFormatCalls = 200000;
+
+// Heap allocations through operator new (String allocations are counted by the native Arduino.h), for all benchmarks
+unsigned long benchNewAllocations = 0;
+
+void* operator new(size_t size) {
+  benchNewAllocations++;
+  void* ptr = malloc(size ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+static unsigned long heapAllocations() {
+  return benchNewAllocations + nativeStringAllocations();
+}
+
+// Display that only folds printed text into a checksum, so printing costs next to nothing
+struct NullDisplay {
+  uint32_t checksum = 0;
+  void setCursor(int, int) { }
+  void print(const char* str) {
+    while (*str) {
+      checksum = checksum * 31 + (byte)*str++;
+    }
+  }
+};
+
+// Former sprintf() based formatters, kept for comparison (with '%ld' argument cast as on 32-bit boards)
+struct LegacyPrtVal {
+  NullDisplay& _displayObj;
+  void  prt_int(uint32_t val, int len) {
+          char sz[32];
+          sprintf(sz, "%ld", (long)(int32_t)val);
+          sz[len] = 0;
+          for (int i=strlen(sz); i<len; ++i)
+                  sz[i] = ' ';
+          if (len > 0)
+                  sz[len-1] = ' ';
+          sz[len] = '\0';
+          _displayObj.print(sz);
+        }
+  void  prt_hex(uint32_t val, int len) {
+          char sz[32];
+          if (len < 2) sprintf(sz, "%lX", (unsigned long)val);
+          else if (len < 4) sprintf(sz, "%02lX", (unsigned long)val);
+          else if (len < 6) sprintf(sz, "%04lX", (unsigned long)val);
+          else if (len < 8) sprintf(sz, "%06lX", (unsigned long)val);
+          else sprintf(sz, "%08lX", (unsigned long)val);
+          sz[len] = 0;
+          for (int i=strlen(sz); i<len; ++i)
+                  sz[i] = ' ';
+          if (len > 0)
+                  sz[len-1] = ' ';
+          sz[len] = '\0';
+          _displayObj.print(sz);
+        }
+  void  prt_float(float val, int len, int prec) {
+          String stz = String(val, prec);
+          char sz[len+1];
+          stz.toCharArray(sz, min(len, (int)stz.length()+1));
+          for (int i=stz.length(); i<len; ++i) sz[i]=' ';
+          sz[len] = '\0';
+          _displayObj.print(sz);
+        }
+};
+
+static uint32_t nextValue(uint32_t& state) {
+  state = state * 1103515245 + 12345;
+  // Mix magnitudes, so that short and long numbers are equally likely
+  return (state >> 8) >> ((state & 0xFF) % 24);
+}
+
+// Compare fmt_* output with snprintf() for random values and all field lengths, return number of mismatches
+static int checkFormatters() {
+  int mismatches = 0;
+  uint32_t state = 7;
+  char expected[40];
+  char actual[40];
+  for (int i=0; i<20000; i++) {
+    uint32_t val = nextValue(state);
+    if (i & 1) {
+      val = 0u - val;
+    }
+    for (int len=0; len<=12; len++) {
+      for (int kind=0; kind<3; kind++) {
+        if (kind == 0) {
+          snprintf(expected, sizeof(expected), "%-12ld", (long)(int32_t)val);
+          TeenyPrtVal<NullDisplay>::fmt_int(actual, len, (int32_t)val);
+        } else if (kind == 1) {
+          snprintf(expected, sizeof(expected), "%-12lu", (unsigned long)val);
+          TeenyPrtVal<NullDisplay>::fmt_uint(actual, len, val);
+        } else {
+          // Precision of 0 would print nothing for 0, unlike the minimum width of fmt_hex()
+          snprintf(expected, sizeof(expected), "%-12.*lX", (len % 9) ? len % 9 : 1, (unsigned long)val);
+          TeenyPrtVal<NullDisplay>::fmt_hex(actual, len, val, len % 9);
+        }
+        expected[len] = '\0';
+        if (strcmp(expected, actual) != 0) {
+          mismatches++;
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+
+// snprintf() text of 'f' with 'prec' decimals, as fmt_float() writes it: ties rounded half away from zero rather than
+// to even, and no sign for values rounded to zero
+static void floatExpected(char* expected, int size, float f, int prec, int& ties) {
+  long double mag = fabsl((long double)f);
+  // Exact in long double, f has 24 significant bits and 10^prec 21 besides its factors of 2
+  long double scaled = mag * powl(10, prec);
+  if (scaled - floorl(scaled) == 0.5L) {
+    mag = nextafterl(mag, INFINITY);
+    ties++;
+  }
+  snprintf(expected, size, "%s%.*Lf", (f < 0) ? "-" : "", prec, mag);
+  if (strspn(expected, "-0.") == strlen(expected) && expected[0] == '-') {
+    memmove(expected, expected + 1, strlen(expected));
+  }
+}
+
+// Compare fmt_float() and fmt_fixed() output with snprintf(), return number of mismatches
+static int checkDecimalFormatters(int& ties) {
+  int mismatches = 0;
+  uint32_t state = 11;
+  char expected[40];
+  char actual[40];
+  ties = 0;
+  for (int i=0; i<20000; i++) {
+    uint32_t bits = nextValue(state);
+    int32_t val = (i & 1) ? -(int32_t)(bits >> 1) : (int32_t)(bits >> 1);
+    // All precisions, with values from about 2e9 down to 2e-7, and values landing on ties
+    int prec = i % 10;
+    float f = (i % 3 == 2) ? (val >> 20) / 64.0f : val / (float)pow(10, i % 16);
+    floatExpected(expected, sizeof(expected), f, prec, ties);
+    TeenyPrtVal<NullDisplay>::fmt_float(actual, strlen(expected), f, prec);
+    if (strcmp(expected, actual) != 0) {
+      mismatches++;
+    }
+    int scale = i % 5;
+    int decimals = scale + (i / 5) % 3;
+    snprintf(expected, sizeof(expected), "%.*f", decimals, val / pow(10, scale));
+    TeenyPrtVal<NullDisplay>::fmt_fixed(actual, strlen(expected), val, scale, decimals);
+    if (strcmp(expected, actual) != 0) {
+      mismatches++;
+    }
+  }
+  // Rounding (half away from zero) and special values
+  static const struct { float f; int32_t fixed; int scale; int prec; const char* expected; } cases[] = {
+    { 0.125f, 12345, 3, 2, "12.35" },
+    { -2.5f, -12345, 3, 2, "-12.35" },
+    { 9.996f, 9999, 3, 1, "10.0" },
+    { -0.001f, -4, 3, 2, "0.00" },
+    { -0.006f, -5, 3, 2, "-0.01" },
+  };
+  static const char* floatExpected[] = { "0.13", "-3", "10.00", "0.00", "-0.01" };
+  static const int floatPrec[] = { 2, 0, 2, 2, 2 };
+  for (int i=0; i<5; i++) {
+    TeenyPrtVal<NullDisplay>::fmt_fixed(actual, 8, cases[i].fixed, cases[i].scale, cases[i].prec);
+    snprintf(expected, sizeof(expected), "%-8s", cases[i].expected);
+    mismatches += (strcmp(expected, actual) != 0);
+    TeenyPrtVal<NullDisplay>::fmt_float(actual, 8, cases[i].f, floatPrec[i]);
+    snprintf(expected, sizeof(expected), "%-8s", floatExpected[i]);
+    mismatches += (strcmp(expected, actual) != 0);
+  }
+  TeenyPrtVal<NullDisplay>::fmt_float(actual, 4, NAN, 2);
+  mismatches += (strcmp(actual, "nan ") != 0);
+  TeenyPrtVal<NullDisplay>::fmt_float(actual, 4, -INFINITY, 2);
+  mismatches += (strcmp(actual, "-inf") != 0);
+  TeenyPrtVal<NullDisplay>::fmt_float(actual, 4, 1e10f, 2);
+  mismatches += (strcmp(actual, "ovf ") != 0);
+  return mismatches;
+}
+
+// Heap allocations per call of 'format'
+template <class F>
+static double allocationsPerCall(F format) {
+  unsigned long before = heapAllocations();
+  for (int i=0; i<1000; i++) {
+    format(i);
+  }
+  return (heapAllocations() - before) / 1000.0;
+}
+
+template <class F>
+static double nsPerCall(F format) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<benchFormatCalls; i++) {
+    format(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / benchFormatCalls;
+}
+
+void benchPrtVal() {
+  NullDisplay display;
+  TeenyPrtVal<NullDisplay> prtVal(display);
+  LegacyPrtVal legacy = { display };
+  static uint32_t values[1024];
+  uint32_t state = 1;
+  for (uint32_t& value : values) {
+    value = nextValue(state);
+  }
+  int ties;
+  printf("formatters: %d mismatches against snprintf", checkFormatters() + checkDecimalFormatters(ties));
+  printf(" (%d floats on a tie, rounded half away from zero)\n", ties);
+  auto legacyInt = [&](int i) { legacy.prt_int(values[i & 1023] - 500000, 12); };
+  auto legacyHex = [&](int i) { legacy.prt_hex(values[i & 1023], 9); };
+  auto legacyFloat = [&](int i) { legacy.prt_float((int32_t)(values[i & 1023] - 500000) / 100.0f, 12, 2); };
+  auto tableInt = [&](int i) { prtVal.prt_int(values[i & 1023] - 500000, 12); };
+  auto tableHex = [&](int i) { prtVal.prt_hex(values[i & 1023], 9); };
+  auto tableFloat = [&](int i) { prtVal.prt_float((int32_t)(values[i & 1023] - 500000) / 100.0f, 12, 2); };
+  auto tableFixed = [&](int i) { prtVal.prt_fixed(values[i & 1023] - 500000, 12, 2, 2); };
+  printf("%-10s %12s %12s %14s %14s\n", "formatter", "legacy ns", "table ns", "legacy allocs", "table allocs");
+  printf("%-10s %12.1f %12.1f %14.2f %14.2f\n", "int", nsPerCall(legacyInt), nsPerCall(tableInt),
+         allocationsPerCall(legacyInt), allocationsPerCall(tableInt));
+  printf("%-10s %12.1f %12.1f %14.2f %14.2f\n", "hex", nsPerCall(legacyHex), nsPerCall(tableHex),
+         allocationsPerCall(legacyHex), allocationsPerCall(tableHex));
+  printf("%-10s %12.1f %12.1f %14.2f %14.2f\n", "float", nsPerCall(legacyFloat), nsPerCall(tableFloat),
+         allocationsPerCall(legacyFloat), allocationsPerCall(tableFloat));
+  printf("%-10s %12s %12.1f %14s %14.2f\n", "fixed", "-", nsPerCall(tableFixed), "-", allocationsPerCall(tableFixed));
+  printf("(checksum %08X)\n\n", (unsigned)display.checksum);
+}
@@ -0,0 +1,285 @@
+/*
+bench_remote.cpp - Remote control benchmark for TeenyMenuRemote (env:native).
+
+Runs a menu headless on a TeenyMenuFrame and drives it with randomized commands through
+a MockStream, checking the replies: frames rendered headless must match frames rendered
+on MockDisplay by a menu given the same keys, bitmap dumps must match the frame buffer,
+text dumps must point at the current item, row texts must be cut at the length asked for
+and values must match the linked variables.
+Reports commands per second and the time per command reported in the replies.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include "MockDisplay.h"
+#include "MockStream.h"
+#include "TeenyMenuFrame.h"
+#include "TeenyMenuRemote.h"
+
+static const int benchRemoteCommands = 20000;
+static const int benchRemoteItems = 24;
+
+static int benchRemoteMin = -500;
+static int benchRemoteMax = 500;
+static TeenyMenuRange benchRemoteRange{&benchRemoteMin, &benchRemoteMax, nullptr, 0};
+static SelectOptionInt benchRemoteOptions[] = { {"Zero", 0}, {"Five", 5}, {"Ten", 10}, {"Fifteen", 15} };
+static TeenyMenuSelect benchRemoteSelect(4, benchRemoteOptions);
+static int benchRemoteButtonPresses = 0;
+
+static void benchRemoteButton() {
+  benchRemoteButtonPresses++;
+}
+
+// Pages of the menu under test, with variables of their own
+struct BenchRemoteTree {
+  int values[benchRemoteItems] = {0};
+  int selectValue = 10;
+  boolean flag = false;
+  TeenyMenuPage mainPage;
+  TeenyMenuPage subPage;
+  TeenyMenuItem* items[benchRemoteItems + 2];
+
+  BenchRemoteTree()
+    : mainPage("REMOTE")
+    , subPage("SUB")
+  {
+    for (int i=0; i<benchRemoteItems; i++) {
+      switch (i % 8) {
+        case 3:
+          items[i] = new TeenyMenuItem("Select", selectValue, benchRemoteSelect);
+          break;
+        case 4:
+          items[i] = new TeenyMenuItem("Flag", flag);
+          break;
+        case 5:
+          items[i] = new TeenyMenuItem("Sub page", subPage);
+          break;
+        case 6:
+          items[i] = (i % 16 == 6) ? new TeenyMenuItem("Label") : new TeenyMenuItem("Button", benchRemoteButton);
+          break;
+        default:
+          items[i] = new TeenyMenuItem("Value", values[i], benchRemoteRange, nullptr, i % 8 == 7);
+          break;
+      }
+      mainPage.addMenuItem(*items[i]);
+    }
+    items[benchRemoteItems] = new TeenyMenuItem();
+    items[benchRemoteItems + 1] = new TeenyMenuItem("Sub value", values[0]);
+    subPage.addMenuItem(*items[benchRemoteItems]);
+    subPage.addMenuItem(*items[benchRemoteItems + 1]);
+  }
+
+  ~BenchRemoteTree() {
+    for (TeenyMenuItem* item : items) {
+      delete item;
+    }
+  }
+
+  // Value of item n of the current page worked out from the variables, false if it is not a value item
+  bool expectedValue(bool onSubPage, int n, int32_t& value) {
+    if (onSubPage) {
+      value = values[0];
+      return(n == 1);
+    }
+    if (n < 0 || n >= benchRemoteItems) {
+      return(false);
+    }
+    switch (n % 8) {
+      case 3:
+        value = selectValue / 5;
+        return(true);
+      case 4:
+        value = flag;
+        return(true);
+      case 5:
+      case 6:
+        return(false);
+      default:
+        value = values[n];
+        return(true);
+    }
+  }
+};
+
+static uint8_t benchRemoteFrame[128 * 64 / 8];
+
+// Menu run headless, and the same menu on MockDisplay, given the same keys
+struct BenchRemoteMenu {
+  BenchRemoteTree tree;
+  TeenyMenuFrame frame;
+  TeenyMenu<TeenyMenuFrame> menu;
+  BenchRemoteTree referenceTree;
+  MockDisplay referenceDisplay;
+  TeenyMenu<MockDisplay> reference;
+
+  BenchRemoteMenu()
+    : frame(benchRemoteFrame)
+    , menu(frame)
+    , reference(referenceDisplay)
+  {
+    menu.setFrameBuffer(frame.getBuffer());
+    menu.setPartialRedraw(true);
+    menu.setMenuPageCurrent(tree.mainPage);
+    menu.drawMenu();
+    reference.setFrameBuffer(referenceDisplay.getBuffer());
+    reference.setMenuPageCurrent(referenceTree.mainPage);
+    reference.drawMenu();
+  }
+};
+
+static uint32_t benchRemoteRandom(uint32_t& state) {
+  state = state * 1103515245 + 12345;
+  return state >> 8;
+}
+
+// Split the output of one command into its lines, the last one being the reply
+static int benchRemoteLines(const std::string& output, std::string* lines, int max) {
+  int count = 0;
+  size_t start = 0;
+  while (start < output.size() && count < max) {
+    size_t end = output.find('\n', start);
+    if (end == std::string::npos) break;
+    lines[count++] = output.substr(start, end - start);
+    start = end + 1;
+  }
+  return count;
+}
+
+void benchRemote() {
+  static BenchRemoteMenu m;
+  MockStream stream;
+  TeenyMenuRemote<TeenyMenuFrame, MockStream> remote(m.menu, stream);
+  static const char keys[] = "UDLR";
+  static const char types[] = "KTBVS";
+  uint32_t reportedUs[5] = {0};
+  int typeCounts[5] = {0};
+  int mismatches = 0;
+  int errors = 0;
+  uint32_t state = 3;
+  std::string lines[16];
+  char command[TEENYMENU_REMOTE_LINE_LEN + 8];
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<benchRemoteCommands; i++) {
+    uint32_t r = benchRemoteRandom(state);
+    int type = (r % 20 < 12) ? 0 : (r % 20 < 15) ? 1 : (r % 20 < 16) ? 2 : (r % 20 < 18) ? 3 : 4;
+    char pressed[4] = {0};
+    int expectedItem = -1;
+    if (type == 0) {
+      int count = 1 + (r >> 5) % 3;
+      for (int k=0; k<count; k++) {
+        pressed[k] = keys[(r >> (8 + k * 2)) & 3];
+      }
+      snprintf(command, sizeof(command), "K %s\n", pressed);
+    } else if (type == 3 && (r >> 5) % 2) {
+      expectedItem = (r >> 6) % (benchRemoteItems + 2);
+      snprintf(command, sizeof(command), "V %d\n", expectedItem);
+    } else {
+      snprintf(command, sizeof(command), "%c\n", types[type]);
+    }
+    if (type == 3 && expectedItem < 0) {
+      expectedItem = m.menu.getCurrentItemNum();
+    }
+    stream.output.clear();
+    stream.feed(command);
+    mismatches += (remote.service() != 1);
+    int count = benchRemoteLines(stream.output, lines, 16);
+    if (count == 0) {
+      mismatches++;
+      continue;
+    }
+    const std::string& reply = lines[count - 1];
+    if (reply.compare(0, 3, "OK ") == 0) {
+      reportedUs[type] += strtoul(reply.c_str() + 3, nullptr, 10);
+      typeCounts[type]++;
+    } else if (type != 3) {
+      mismatches++;
+    }
+    switch (type) {
+      case 0:
+        for (int k=0; pressed[k]; k++) {
+          m.reference.registerKeyPress((pressed[k] == 'U') ? TEENYMENU_KEY_UP : (pressed[k] == 'D') ? TEENYMENU_KEY_DOWN :
+                                       (pressed[k] == 'L') ? TEENYMENU_KEY_LEFT : TEENYMENU_KEY_RIGHT);
+        }
+        mismatches += (memcmp(benchRemoteFrame, m.referenceDisplay.getBuffer(), sizeof(benchRemoteFrame)) != 0);
+        break;
+      case 1: {
+        // Title, then the rows on screen with the current one marked
+        mismatches += (lines[0] != std::string("# ") + (m.menu.isMenuPageCurrent(m.tree.subPage) ? "SUB" : "REMOTE"));
+        int marked = 0;
+        for (int l=1; l<count-1; l++) {
+          if (lines[l].compare(0, 2, "> ") == 0) {
+            marked++;
+            // Current value item shown with the value of its variable
+            int n = m.menu.getCurrentItemNum();
+            int32_t value;
+            if (m.tree.expectedValue(m.menu.isMenuPageCurrent(m.tree.subPage), n, value) && n % 8 < 3 &&
+                !m.menu.getNavigation().editValueMode) {
+              mismatches += (lines[l] != std::string("> ") + (n == 1 && m.menu.isMenuPageCurrent(m.tree.subPage) ? "Sub value:" : "Value:") +
+                                         std::to_string(value));
+            }
+          }
+        }
+        mismatches += (marked != 1 || count - 2 > 6);
+        break;
+      }
+      case 2:
+        mismatches += (count != 9);
+        for (int page=0; page<8 && page<count-1; page++) {
+          for (int col=0; col<128; col++) {
+            unsigned byteValue = strtoul(lines[page].substr(col * 2, 2).c_str(), nullptr, 16);
+            if (byteValue != benchRemoteFrame[page * 128 + col]) {
+              mismatches++;
+              page = 8;
+              break;
+            }
+          }
+        }
+        break;
+      case 3: {
+        int32_t expected;
+        if (m.tree.expectedValue(m.menu.isMenuPageCurrent(m.tree.subPage), expectedItem, expected)) {
+          mismatches += (count != 2 || lines[0] != "= " + std::to_string(expected));
+        } else {
+          mismatches += (reply != "ERR not a value item");
+          errors++;
+        }
+        break;
+      }
+      case 4: {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "S %u %d %d", (unsigned)m.menu.getCurrentItemNum(),
+                 m.menu.getNavigation().editValueMode ? 1 : 0, m.menu.getNavigation().depth + m.menu.getNavigation().depthBeyond);
+        mismatches += (lines[0] != expected);
+        break;
+      }
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  // Malformed commands are answered with errors and leave the menu alone
+  static const char* bad[] = { "X\n", "K DQ\n", "V 7x\n", "K UUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUU\n" };
+  int rejected = 0;
+  teenyMenu_row_t itemNum = m.menu.getCurrentItemNum();
+  for (const char* line : bad) {
+    stream.output.clear();
+    stream.feed(line);
+    remote.service();
+    rejected += (stream.output.compare(0, 4, "ERR ") == 0);
+  }
+  mismatches += (rejected != 4 || m.menu.getCurrentItemNum() != itemNum);
+  // Row texts asked for shorter than they are are cut at the supplied length
+  char full[TEENYMENU_REMOTE_TEXT_LEN+1];
+  char text[TEENYMENU_REMOTE_TEXT_LEN+1];
+  for (teenyMenu_row_t row=0; m.menu.getRowText(row, full, TEENYMENU_REMOTE_TEXT_LEN); row++) {
+    for (byte len=0; len<=strlen(full); len++) {
+      memset(text, '#', sizeof(text));
+      mismatches += !m.menu.getRowText(row, text, len) || std::string(text) != std::string(full, len);
+    }
+  }
+  printf("remote: %d commands, %.0f commands/s, %d mismatches (%d queries of items that are not values)\n",
+         benchRemoteCommands, benchRemoteCommands / seconds, mismatches, errors);
+  printf("remote: reported us per command: K %.2f, T %.2f, B %.2f, V %.2f, S %.2f\n\n",
+         (double)reportedUs[0] / max(typeCounts[0], 1), (double)reportedUs[1] / max(typeCounts[1], 1),
+         (double)reportedUs[2] / max(typeCounts[2], 1), (double)reportedUs[3] / max(typeCounts[3], 1),
+         (double)reportedUs[4] / max(typeCounts[4], 1));
+}
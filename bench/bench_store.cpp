@@ -0,0 +1,245 @@
+/*
+bench_store.cpp - Persistence benchmark for TeenyMenuStore (env:native).
+
+Registers the variables of a small page tree (with pages linking to each other) in a store
+kept in a FileEEPROM, edits them in bursts and compares the EEPROM writes and the wear of the
+most written byte against saving each variable to its own address on every save. Then checks
+that a store opened on the same file restores the latest values, that a record cut short
+after any of its bytes is skipped for the previous one, and that stores with areas too short
+for two records don't write past their area.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+
+// The quiet period of the store runs on the bench's own clock
+static uint32_t benchStoreNow = 0;
+#define TEENYMENU_STORE_CLOCK() benchStoreNow
+
+#include "FileEEPROM.h"
+#include "TeenyMenuStore.h"
+
+static const char* benchStoreFile = "/tmp/teenymenu_store.bin";
+static const char* benchStoreCutFile = "/tmp/teenymenu_store_cut.bin";
+static const uint16_t benchStoreLength = 512;
+static const uint16_t benchStoreQuietMs = 2000;
+static const int benchStoreBursts = 500;
+
+struct BenchStoreVars {
+  byte brightness;
+  int volume;
+  int32_t offset;
+  boolean flag;
+  int channel;
+  byte mode;
+};
+
+static BenchStoreVars benchStoreVars;
+static int benchStoreSensor;  // Readonly, must not be kept
+
+static SelectOptionInt benchStoreChannels[] = { {"A", 10}, {"B", 20}, {"C", 30} };
+static SelectOptionByte benchStoreModes[] = { {"Off", 0}, {"On", 1}, {"Auto", 2} };
+static TeenyMenuSelect benchStoreChannelSelect(3, benchStoreChannels);
+static TeenyMenuSelect benchStoreModeSelect(3, benchStoreModes);
+static TeenyMenuPage benchStoreMain("MAIN");
+static TeenyMenuPage benchStoreSub("SUB");
+static TeenyMenuItem benchStoreItems[] = {
+  TeenyMenuItem("Brightness", benchStoreVars.brightness),
+  TeenyMenuItem("Volume", benchStoreVars.volume),
+  TeenyMenuItem("Flag", benchStoreVars.flag),
+  TeenyMenuItem("Channel", benchStoreVars.channel, benchStoreChannelSelect),
+  TeenyMenuItem("Sub page", benchStoreSub),
+  TeenyMenuItem(),
+  TeenyMenuItem("Offset", benchStoreVars.offset),
+  TeenyMenuItem("Mode", benchStoreVars.mode, benchStoreModeSelect),
+  TeenyMenuItem("Sensor", benchStoreSensor, TEENYMENU_READONLY),
+  TeenyMenuItem("Volume", benchStoreVars.volume),
+  TeenyMenuItem("Main page", benchStoreMain),
+};
+
+static void benchStorePages() {
+  static bool built = false;
+  if (built) return;
+  built = true;
+  for (int i=0; i<5; i++) {
+    benchStoreMain.addMenuItem(benchStoreItems[i]);
+  }
+  for (int i=5; i<11; i++) {
+    benchStoreSub.addMenuItem(benchStoreItems[i]);
+  }
+}
+
+static uint32_t benchStoreRandom(uint32_t& state) {
+  state = state * 1103515245 + 12345;
+  return state >> 8;
+}
+
+// Change one of the variables the way saving its menu item would, return its address and size
+static void* benchStoreEdit(uint32_t& state, byte& size) {
+  uint32_t r = benchStoreRandom(state);
+  switch (r % 6) {
+    case 0: benchStoreVars.brightness = (byte)(r >> 3); size = sizeof(byte); return &benchStoreVars.brightness;
+    case 1: benchStoreVars.volume = (int)(r >> 3) % 1000; size = sizeof(int); return &benchStoreVars.volume;
+    case 2: benchStoreVars.offset = (int32_t)(r >> 3) - 100000; size = sizeof(int32_t); return &benchStoreVars.offset;
+    case 3: benchStoreVars.flag = !benchStoreVars.flag; size = sizeof(boolean); return &benchStoreVars.flag;
+    case 4: benchStoreVars.channel = benchStoreChannels[(r >> 3) % 3].val_int; size = sizeof(int); return &benchStoreVars.channel;
+    default: benchStoreVars.mode = benchStoreModes[(r >> 3) % 3].val_byte; size = sizeof(byte); return &benchStoreVars.mode;
+  }
+}
+
+// Storage whose writes stop after a number of update() calls, like EEPROM when the power goes
+struct CutEEPROM {
+  FileEEPROM& eeprom;
+  int updatesLeft;
+  uint8_t read(int address) { return eeprom.read(address); }
+  void update(int address, uint8_t value) {
+    if (updatesLeft > 0) {
+      updatesLeft--;
+      eeprom.update(address, value);
+    }
+  }
+};
+
+// Restore must load the record written before one cut short after 0 to (record length - 1) updates
+static int benchStoreCut(int& cuts) {
+  remove(benchStoreCutFile);
+  FileEEPROM eeprom(benchStoreCutFile, benchStoreLength);
+  uint32_t state = 5;
+  int mismatches = 0;
+  cuts = 0;
+  for (int round=0; round<3; round++) {
+    for (int updates=0; ; updates++) {
+      TeenyMenuStore<FileEEPROM> store(eeprom, 0, benchStoreLength, benchStoreQuietMs);
+      store.addMenuPage(benchStoreMain);
+      store.restore();
+      byte size;
+      benchStoreEdit(state, size);
+      store.service();
+      store.flush();
+      BenchStoreVars saved = benchStoreVars;
+      if (updates == store.getSlotLength()) break;
+      CutEEPROM cut{eeprom, updates};
+      TeenyMenuStore<CutEEPROM> cutStore(cut, 0, benchStoreLength, benchStoreQuietMs);
+      cutStore.addMenuPage(benchStoreMain);
+      cutStore.restore();
+      benchStoreVars.volume++;
+      benchStoreVars.brightness++;
+      cutStore.service();
+      cutStore.flush();
+      cuts++;
+      memset(&benchStoreVars, 0, sizeof(benchStoreVars));
+      TeenyMenuStore<FileEEPROM> rebooted(eeprom, 0, benchStoreLength, benchStoreQuietMs);
+      rebooted.addMenuPage(benchStoreMain);
+      mismatches += !rebooted.restore();
+      mismatches += (memcmp(&benchStoreVars, &saved, sizeof(saved)) != 0);
+    }
+  }
+  return mismatches;
+}
+
+// Storage areas shorter than two records: variables that would not fit twice are refused, records are written and
+// restored within the area, bytes around it stay erased
+static int benchStoreShort() {
+  static const char* file = "/tmp/teenymenu_store_short.bin";
+  static const uint16_t address = 64;
+  // Record: 5 header bytes, the variables, 2 CRC bytes
+  static const uint16_t brightnessLength = 2 * (5 + 1 + 2);
+  static const uint16_t volumeLength = 2 * (5 + 1 + sizeof(int) + 2);
+  int mismatches = 0;
+  for (uint16_t length=0; length<=volumeLength + 2; length++) {
+    remove(file);
+    FileEEPROM eeprom(file, 128);
+    benchStoreVars.brightness = 1;
+    benchStoreVars.volume = 2;
+    TeenyMenuStore<FileEEPROM> store(eeprom, address, length, benchStoreQuietMs);
+    mismatches += (store.addVariable(&benchStoreVars.brightness, 1) != (length >= brightnessLength));
+    mismatches += (store.addVariable(&benchStoreVars.volume, sizeof(int)) != (length >= volumeLength));
+    store.restore();
+    benchStoreVars.brightness++;
+    benchStoreVars.volume++;
+    store.service();
+    bool written = store.flush();
+    mismatches += (written != (length >= brightnessLength));
+    for (int i=0; i<eeprom.length(); i++) {
+      mismatches += ((i < address || i >= address + length) && eeprom.read(i) != 0xFF);
+    }
+    BenchStoreVars saved = benchStoreVars;
+    memset(&benchStoreVars, 0, sizeof(benchStoreVars));
+    TeenyMenuStore<FileEEPROM> rebooted(eeprom, address, length, benchStoreQuietMs);
+    rebooted.addVariable(&benchStoreVars.brightness, 1);
+    rebooted.addVariable(&benchStoreVars.volume, sizeof(int));
+    mismatches += (rebooted.restore() != written);
+    mismatches += (written && benchStoreVars.brightness != saved.brightness);
+    mismatches += (length >= volumeLength && benchStoreVars.volume != saved.volume);
+  }
+  remove(file);
+  return mismatches;
+}
+
+void benchStore() {
+  benchStorePages();
+  memset(&benchStoreVars, 0, sizeof(benchStoreVars));
+  remove(benchStoreFile);
+  int mismatches = 0;
+  uint32_t edits = 0;
+  uint32_t records = 0;
+  byte variablesCount;
+  {
+    FileEEPROM eeprom(benchStoreFile, benchStoreLength);
+    FileEEPROM direct("/tmp/teenymenu_store_direct.bin", benchStoreLength);
+    TeenyMenuStore<FileEEPROM> store(eeprom, 0, benchStoreLength, benchStoreQuietMs);
+    mismatches += !store.addMenuPage(benchStoreMain);
+    variablesCount = store.getVariablesCount();
+    // Nothing written yet, nothing to restore
+    mismatches += store.restore();
+    uint32_t state = 1;
+    for (int burst=0; burst<benchStoreBursts; burst++) {
+      int burstEdits = 1 + benchStoreRandom(state) % 20;
+      for (int i=0; i<burstEdits; i++) {
+        byte size;
+        uint8_t* variable = (uint8_t*)benchStoreEdit(state, size);
+        benchStoreSensor++;
+        edits++;
+        // Saving each variable on its own, to a fixed address, like EEPROM.put() from saveAction
+        int address = variable - (uint8_t*)&benchStoreVars;
+        for (byte j=0; j<size; j++) {
+          direct.update(address + j, variable[j]);
+        }
+        // loop() passes between two edits, 10 ms apart
+        uint32_t gap = 100 + benchStoreRandom(state) % 400;
+        for (uint32_t t=0; t<gap; t+=10) {
+          benchStoreNow += 10;
+          records += store.service();
+        }
+      }
+      for (uint32_t t=0; t<benchStoreQuietMs * 2; t+=10) {
+        benchStoreNow += 10;
+        records += store.service();
+      }
+      mismatches += store.isDirty();
+    }
+    printf("store: %d variables in %u-byte records, %u slots; %u edits in %d bursts\n",
+           variablesCount, (unsigned)store.getSlotLength(), (unsigned)store.getSlotsCount(), (unsigned)edits, benchStoreBursts);
+    printf("%-16s %9s %12s %15s\n", "", "records", "byte writes", "most writes/B");
+    printf("%-16s %9u %12u %15u\n", "save each", (unsigned)edits, (unsigned)direct.getWrites(), (unsigned)direct.getMaxCellWrites());
+    printf("%-16s %9u %12u %15u\n", "store", (unsigned)records, (unsigned)eeprom.getWrites(), (unsigned)eeprom.getMaxCellWrites());
+  }
+  // Reboot: the file holds the latest values
+  BenchStoreVars saved = benchStoreVars;
+  memset(&benchStoreVars, 0, sizeof(benchStoreVars));
+  FileEEPROM eeprom(benchStoreFile, benchStoreLength);
+  TeenyMenuStore<FileEEPROM> store(eeprom, 0, benchStoreLength, benchStoreQuietMs);
+  store.addMenuPage(benchStoreMain);
+  auto start = std::chrono::steady_clock::now();
+  mismatches += !store.restore();
+  double restoreUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  mismatches += (memcmp(&benchStoreVars, &saved, sizeof(saved)) != 0);
+  // Restored values are not dirty
+  store.service();
+  mismatches += store.isDirty();
+  int cuts;
+  int cutMismatches = benchStoreCut(cuts);
+  printf("store: restore %.1f us, %d mismatches; %d records cut short, %d mismatches\n",
+         restoreUs, mismatches, cuts, cutMismatches);
+  printf("store: short storage areas %d mismatches\n\n", benchStoreShort());
+}
@@ -0,0 +1,422 @@
+/*
+bench_value.cpp - Typed value items benchmark for TeenyMenuValue<V> (env:native).
+
+Edits a page with an item of each supported type (8 to 64-bit integers, float) with random
+runs of key presses, some items with accelerating edit steps, checking after every key press
+the text of each row against printf and the variables against a reference model, also from
+values short of the range ends by fractions of a step, with guard bytes around each variable so that
+reads or writes of the wrong width show up. Then checks that refreshValues() notices a
+change in any byte of the variables, that TeenyMenuIndex gets and sets them within their
+range and that TeenyMenuStore keeps each with its own size, and times drawing a page of
+TeenyMenuValue<int> items against a page of TeenyMenuItem int items.
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include "MockDisplay.h"
+#include "TeenyMenu.h"
+#include "TeenyMenuStore.h"
+
+static const int benchValueKeys = 20000;
+static const int benchValueDraws = 20000;
+static const uint8_t benchValueGuard = 0x5A;
+// Key presses of a run always count as repeats (see TeenyMenu::setEditAcceleration()), the step size grows every 3
+static const int benchValueRepeatsPerStep = 3;
+
+static int benchValueSaves = 0;
+
+static void benchValueSave() {
+  benchValueSaves++;
+}
+
+// Variable between guard bytes, written only through the menu, the index and the store
+template <class V>
+struct BenchValueVar {
+  uint8_t before[8];
+  V value;
+  uint8_t after[8];
+
+  BenchValueVar(V value_) : value(value_) {
+    memset(before, benchValueGuard, sizeof(before));
+    memset(after, benchValueGuard, sizeof(after));
+  }
+
+  bool guarded() const {
+    for (int i=0; i<8; i++) {
+      if (before[i] != benchValueGuard || after[i] != benchValueGuard) return false;
+    }
+    return true;
+  }
+};
+
+// Item of the page under test with its reference model: values in long double, which holds any of them exactly
+struct BenchValueRow {
+  TeenyMenuItem* item;
+  const char* title;
+  long double rangeMin;
+  long double rangeMax;
+  long double step;
+  bool readonly;
+  const char* format;                            // printf format of the value, as long double or long long
+  const int32_t* editSteps;                      // Edit steps set on the item, or nullptr
+  int editStepsCount;
+  int size;                                      // Size of the variable
+  long double (*get)(void* var);
+  void (*set)(void* var, long double value);
+  bool (*guarded)(void* var);
+  void (*flip)(void* var, int byteNum);          // Change a byte of the variable
+  void* var;
+};
+
+template <class V>
+static long double benchValueGet(void* var) {
+  return (long double)((BenchValueVar<V>*)var)->value;
+}
+
+template <class V>
+static void benchValueSet(void* var, long double value) {
+  ((BenchValueVar<V>*)var)->value = (V)value;
+}
+
+template <class V>
+static bool benchValueGuarded(void* var) {
+  return ((BenchValueVar<V>*)var)->guarded();
+}
+
+template <class V>
+static void benchValueFlip(void* var, int byteNum) {
+  ((uint8_t*)&((BenchValueVar<V>*)var)->value)[byteNum % sizeof(V)] ^= 0x01;
+}
+
+struct BenchValuePage {
+  BenchValueVar<int64_t> i64{-9000000000000000000LL};
+  BenchValueVar<float> f{0.5f};
+  BenchValueVar<uint32_t> u32{3000000000u};
+  BenchValueVar<uint8_t> u8{200};
+  BenchValueVar<int8_t> i8{-100};
+  BenchValueVar<int16_t> i16{-30000};
+  BenchValueVar<uint16_t> u16{1000};
+  BenchValueVar<int32_t> i32{0};
+  BenchValueVar<int64_t> sensor{123456789012LL};
+  TeenyMenuValue<int64_t> itemI64{"I64", i64.value, INT64_MIN, INT64_MAX, 1000000000000000000LL, benchValueSave};
+  TeenyMenuValue<float> itemF{"F", f.value, -1.5f, 2.0f, 0.25f, benchValueSave};
+  TeenyMenuValue<uint32_t> itemU32{"U32", u32.value, 0, 4000000000u, 300000000};
+  TeenyMenuValue<uint8_t> itemU8{"U8", u8.value, 0, 250, 7, benchValueSave};
+  TeenyMenuValue<int8_t> itemI8{"I8", i8.value, -100, 100, 9};
+  TeenyMenuValue<int16_t> itemI16{"I16", i16.value, -30000, 30000, 2500};
+  TeenyMenuValue<uint16_t> itemU16{"U16", u16.value, benchValueSave};
+  TeenyMenuValue<int32_t> itemI32{"I32", i32.value, INT32_MIN, INT32_MAX, 1000000000};
+  TeenyMenuValue<int64_t> itemSensor{"Sensor", sensor.value, TEENYMENU_READONLY};
+  TeenyMenuPage page{"VALUES"};
+  BenchValueRow rows[9];
+
+  BenchValuePage() {
+    TeenyMenuItem* items[] = { &itemI64, &itemF, &itemU32, &itemU8, &itemI8, &itemI16, &itemU16, &itemI32, &itemSensor };
+    page.addMenuItems(items, 9);
+    rows[0] = row<int64_t>(itemI64, "I64", INT64_MIN, INT64_MAX, 1e18L, false, "%lld", &i64);
+    rows[1] = row<float>(itemF, "F", -1.5L, 2.0L, 0.25L, false, "%.2Lf", &f);
+    rows[2] = row<uint32_t>(itemU32, "U32", 0, 4000000000.0L, 300000000, false, "%lld", &u32);
+    rows[3] = row<uint8_t>(itemU8, "U8", 0, 250, 7, false, "%lld", &u8);
+    rows[4] = row<int8_t>(itemI8, "I8", -100, 100, 9, false, "%lld", &i8);
+    rows[5] = row<int16_t>(itemI16, "I16", -30000, 30000, 2500, false, "%lld", &i16);
+    rows[6] = row<uint16_t>(itemU16, "U16", 0, 65535, 1, false, "%lld", &u16);
+    rows[7] = row<int32_t>(itemI32, "I32", INT32_MIN, INT32_MAX, 1e9L, false, "%lld", &i32);
+    rows[8] = row<int64_t>(itemSensor, "Sensor", INT64_MIN, INT64_MAX, 1, true, "%lld", &sensor);
+    static const int32_t stepsI64[] = { 1, 3 };
+    static const int32_t stepsF[] = { 1, 2 };
+    static const int32_t stepsU8[] = { 1, 5, 20 };
+    static const int32_t stepsI16[] = { 1, 4, 1000 };
+    editSteps(0, stepsI64, 2);
+    editSteps(1, stepsF, 2);
+    editSteps(3, stepsU8, 3);
+    editSteps(5, stepsI16, 3);
+  }
+
+  void editSteps(int rowNum, const int32_t* steps, int count) {
+    rows[rowNum].item->setEditSteps(steps, count);
+    rows[rowNum].editSteps = steps;
+    rows[rowNum].editStepsCount = count;
+  }
+
+  template <class V>
+  static BenchValueRow row(TeenyMenuItem& item, const char* title, long double rangeMin, long double rangeMax,
+                           long double step, bool readonly, const char* format, BenchValueVar<V>* var) {
+    return { &item, title, rangeMin, rangeMax, step, readonly, format, nullptr, 0, (int)sizeof(V), benchValueGet<V>,
+             benchValueSet<V>, benchValueGuarded<V>, benchValueFlip<V>, var };
+  }
+
+  bool guarded() {
+    for (BenchValueRow& r : rows) {
+      if (!r.guarded(r.var)) return false;
+    }
+    return true;
+  }
+};
+
+// Text of the row as TeenyMenu::getRowText() gives it, for 'value' formatted with printf
+static std::string benchValueText(const BenchValueRow& row, long double value) {
+  char text[64];
+  if (row.format[1] == '.') {
+    snprintf(text, sizeof(text), row.format, value);
+  } else {
+    snprintf(text, sizeof(text), row.format, (long long)value);
+  }
+  return std::string(row.title) + (row.readonly ? "=" : ":") + text;
+}
+
+// Value after a key press while editing, by the rules TeenyMenuValue documents: 'steps' steps up or down, stopping at
+// the range ends
+static long double benchValueStep(const BenchValueRow& row, long double value, int steps) {
+  if (value < row.rangeMin) return row.rangeMin;
+  if (value > row.rangeMax) return row.rangeMax;
+  value += steps * row.step;
+  return (value < row.rangeMin) ? row.rangeMin : (value > row.rangeMax) ? row.rangeMax : value;
+}
+
+// Value after Up or Down while editing, with the step size TeenyMenu picks from the repeats of the key so far
+static long double benchValueKey(const BenchValueRow& row, long double value, int key, int& repeatKey, int& repeatCount) {
+  int steps = 1;
+  if (row.editSteps != nullptr) {
+    repeatCount = (key == repeatKey) ? min(repeatCount + 1, 255) : 0;
+    repeatKey = key;
+    steps = row.editSteps[min(repeatCount / benchValueRepeatsPerStep, row.editStepsCount - 1)];
+  }
+  return benchValueStep(row, value, (key == TEENYMENU_KEY_UP) ? steps : -steps);
+}
+
+// Random runs of key presses, checked against the reference model after each one
+static int benchValueEdits(BenchValuePage& values, int& edits, int& saves) {
+  MockDisplay display;
+  // Value cells wide enough for any of the values, so that the text is not cut
+  TeenyMenu<MockDisplay> menu(display, 10, 9, 6, 5, 6, 45, 21);
+  menu.setEditAcceleration(60000, benchValueRepeatsPerStep);
+  menu.setMenuPageCurrent(values.page);
+  menu.drawMenu();
+  int mismatches = 0;
+  long double editValue = 0;
+  uint32_t state = 2024;
+  int runKey = TEENYMENU_KEY_NONE;
+  int runLength = 0;
+  // Repeats of Up or Down on items with edit steps while editing, as TeenyMenu counts them
+  int repeatKey = TEENYMENU_KEY_NONE;
+  int repeatCount = 0;
+  for (int n=0; n<benchValueKeys; n++) {
+    state = state * 1103515245 + 12345;
+    bool editing = menu.getNavigation().editValueMode;
+    BenchValueRow& current = values.rows[menu.getCurrentItemNum()];
+    if (runLength == 0) {
+      // Long runs of Up or Down while editing, to reach the range ends
+      int pick = (state >> 8) % 20;
+      runKey = (pick < 8) ? TEENYMENU_KEY_UP : (pick < 16) ? TEENYMENU_KEY_DOWN :
+               (pick < 19) ? TEENYMENU_KEY_RIGHT : TEENYMENU_KEY_LEFT;
+      runLength = (editing && pick < 16) ? 1 + (state >> 16) % 16 : 1;
+    }
+    runLength--;
+    if (editing && (runKey == TEENYMENU_KEY_UP || runKey == TEENYMENU_KEY_DOWN)) {
+      editValue = benchValueKey(current, editValue, runKey, repeatKey, repeatCount);
+    }
+    if (editing) {
+      if (runKey == TEENYMENU_KEY_RIGHT) edits++;
+    } else if (runKey == TEENYMENU_KEY_RIGHT) {
+      // Entering edit mode starts counting repeats anew
+      editValue = current.get(current.var);
+      repeatKey = TEENYMENU_KEY_NONE;
+      repeatCount = 0;
+    }
+    int savesBefore = benchValueSaves;
+    menu.registerKeyPress(runKey);
+    saves += benchValueSaves - savesBefore;
+    if (editing && runKey == TEENYMENU_KEY_RIGHT) {
+      mismatches += (current.get(current.var) != editValue);
+    }
+    bool editingNow = menu.getNavigation().editValueMode;
+    mismatches += (editingNow != (runKey == TEENYMENU_KEY_RIGHT ? !editing : (editing && runKey != TEENYMENU_KEY_LEFT)));
+    for (int i=0; i<9; i++) {
+      BenchValueRow& row = values.rows[i];
+      bool edited = editingNow && i == menu.getCurrentItemNum();
+      char text[64];
+      mismatches += !menu.getRowText(i, text, sizeof(text) - 1) || benchValueText(row, edited ? editValue : row.get(row.var)) != text;
+    }
+    mismatches += !values.guarded();
+  }
+  if (menu.getNavigation().editValueMode) {
+    menu.registerKeyPress(TEENYMENU_KEY_LEFT);
+  }
+  return mismatches;
+}
+
+// Runs of Up (Down) from values short of the range end by fractions of a step, so that steps land on the end, stop
+// short of it or would go past it; editing is cancelled after each run
+static int benchValueEnds(BenchValuePage& values) {
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display, 10, 9, 6, 5, 6, 45, 21);
+  menu.setEditAcceleration(60000, benchValueRepeatsPerStep);
+  menu.setMenuPageCurrent(values.page);
+  menu.drawMenu();
+  int mismatches = 0;
+  for (int i=0; i<9; i++) {
+    BenchValueRow& row = values.rows[i];
+    if (row.readonly) {
+      // Down skips readonly items
+      continue;
+    }
+    mismatches += (menu.getCurrentItemNum() != i);
+    static const int keys[] = { TEENYMENU_KEY_UP, TEENYMENU_KEY_DOWN };
+    for (int key : keys) {
+      for (int thirds=0; thirds<9; thirds++) {
+        long double distance = thirds * row.step / 3;
+        if (row.format[1] != '.') distance = truncl(distance);
+        long double value = (key == TEENYMENU_KEY_UP) ? max(row.rangeMax - distance, row.rangeMin) :
+                                                        min(row.rangeMin + distance, row.rangeMax);
+        row.set(row.var, value);
+        long double start = row.get(row.var);
+        value = start;
+        int repeatKey = TEENYMENU_KEY_NONE;
+        int repeatCount = 0;
+        menu.registerKeyPress(TEENYMENU_KEY_RIGHT);
+        for (int n=0; n<10; n++) {
+          menu.registerKeyPress(key);
+          value = benchValueKey(row, value, key, repeatKey, repeatCount);
+          char text[64];
+          mismatches += !menu.getRowText(i, text, sizeof(text) - 1) || benchValueText(row, value) != text;
+        }
+        menu.registerKeyPress(TEENYMENU_KEY_LEFT);
+        mismatches += (row.get(row.var) != start);
+      }
+    }
+    menu.registerKeyPress(TEENYMENU_KEY_DOWN);
+  }
+  return mismatches + !values.guarded();
+}
+
+// refreshValues() redraws a value whichever of its bytes changed, and only then
+static int benchValueRefresh(BenchValuePage& values) {
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display);
+  menu.setMenuPageCurrent(values.page);
+  menu.drawMenu();
+  int mismatches = 0;
+  for (int i=0; i<6; i++) {
+    BenchValueRow& row = values.rows[i];
+    for (int byteNum=0; byteNum<8; byteNum++) {
+      mismatches += menu.refreshValues();
+      row.flip(row.var, byteNum);
+      mismatches += !menu.refreshValues();
+      row.flip(row.var, byteNum);
+      mismatches += !menu.refreshValues();
+    }
+  }
+  return mismatches + !values.guarded();
+}
+
+// TeenyMenuIndex: integer values within the range of the item and of int32_t only
+static int benchValueIndex(BenchValuePage& values) {
+  TeenyMenuIndex index;
+  index.build(values.page);
+  int mismatches = 0;
+  int32_t got = 0;
+  int saves = benchValueSaves;
+  values.u8.value = 10;
+  mismatches += index.set("U8", 300) || index.set("U8", 251) || index.set("U8", -1) || values.u8.value != 10;
+  mismatches += !index.set("U8", 14) || values.u8.value != 14 || !index.get("U8", got) || got != 14;
+  mismatches += !index.set("I8", -100) || values.i8.value != -100 || index.set("I8", -101) || index.set("I8", 156);
+  mismatches += !index.set("U32", 5) || !index.get("U32", got) || got != 5;
+  values.u32.value = 3000000000u;
+  mismatches += index.get("U32", got);
+  mismatches += !index.set("I64", -7) || values.i64.value != -7 || !index.get("I64", got) || got != -7;
+  values.i64.value = 1LL << 40;
+  mismatches += index.get("I64", got);
+  values.f.value = 0.5f;
+  mismatches += index.set("F", 1) || index.get("F", got) || values.f.value != 0.5f;
+  mismatches += index.set("Sensor", 1) || index.get("Sensor", got);
+  mismatches += (benchValueSaves - saves != 2);  // U8 and I64 have a save action, I8 and U32 don't
+  return mismatches + !values.guarded();
+}
+
+// Storage with the interface of Arduino EEPROM, in memory
+struct BenchValueEEPROM {
+  uint8_t bytes[256] = {};
+  uint8_t read(int address) { return bytes[address]; }
+  void update(int address, uint8_t value) { bytes[address] = value; }
+  uint16_t length() { return sizeof(bytes); }
+};
+
+// TeenyMenuStore keeps each variable with its own size: a record holds them all and brings them back
+static int benchValueStore(BenchValuePage& values) {
+  BenchValueEEPROM eeprom;
+  TeenyMenuStore<BenchValueEEPROM> store(eeprom, 0, sizeof(eeprom.bytes), 0);
+  int mismatches = !store.addMenuPage(values.page);
+  int size = 0;
+  for (BenchValueRow& row : values.rows) {
+    if (!row.readonly) size += row.size;
+  }
+  mismatches += (store.getVariablesCount() != 8 || store.getSlotLength() != 5 + size + 2);
+  values.i64.value = -1234567890123456789LL;
+  values.f.value = -1.25f;
+  values.u32.value = 4000000000u;
+  values.u16.value = 65535;
+  mismatches += !store.flush();
+  long double saved[9];
+  for (int i=0; i<9; i++) saved[i] = values.rows[i].get(values.rows[i].var);
+  values.i64.value = 0;
+  values.f.value = 0;
+  values.u32.value = 0;
+  values.u16.value = 0;
+  values.i8.value = 0;
+  TeenyMenuStore<BenchValueEEPROM> rebooted(eeprom, 0, sizeof(eeprom.bytes), 0);
+  rebooted.addMenuPage(values.page);
+  mismatches += !rebooted.restore();
+  for (int i=0; i<9; i++) mismatches += (values.rows[i].get(values.rows[i].var) != saved[i]);
+  return mismatches + !values.guarded();
+}
+
+// drawMenu() of a page of changing int values, TeenyMenuValue<int> items against TeenyMenuItem ones
+template <class I>
+static double benchValueDrawUs(int* vars, int count, I* items[]) {
+  MockDisplay display;
+  TeenyMenu<MockDisplay> menu(display);
+  TeenyMenuPage page("DRAW");
+  for (int i=0; i<count; i++) page.addMenuItem(*items[i]);
+  menu.setMenuPageCurrent(page);
+  auto start = std::chrono::steady_clock::now();
+  for (int n=0; n<benchValueDraws; n++) {
+    vars[n % count] += 7;
+    menu.drawMenu();
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / benchValueDraws;
+}
+
+void benchValue() {
+  static BenchValuePage values;
+  int edits = 0;
+  int saves = 0;
+  int mismatches = benchValueEdits(values, edits, saves);
+  printf("value: %d keys, %d values saved, %d save actions, %d mismatches\n", benchValueKeys, edits, saves, mismatches);
+  int endsMismatches = benchValueEnds(values);
+  int refreshMismatches = benchValueRefresh(values);
+  int indexMismatches = benchValueIndex(values);
+  int storeMismatches = benchValueStore(values);
+  printf("value: range ends %d mismatches, refreshValues() %d mismatches, index %d mismatches, store %d mismatches\n",
+         endsMismatches, refreshMismatches, indexMismatches, storeMismatches);
+
+  static int typedVars[6] = {};
+  static int plainVars[6] = {};
+  static int rangeMin = -1000000;
+  static int rangeMax = 1000000;
+  static TeenyMenuRange range{&rangeMin, &rangeMax, nullptr, 0};
+  TeenyMenuValue<int>* typedItems[6];
+  TeenyMenuItem* plainItems[6];
+  for (int i=0; i<6; i++) {
+    typedItems[i] = new TeenyMenuValue<int>("Value", typedVars[i], -1000000, 1000000, 1);
+    plainItems[i] = new TeenyMenuItem("Value", plainVars[i], range);
+  }
+  double typedUs = benchValueDrawUs(typedVars, 6, typedItems);
+  double plainUs = benchValueDrawUs(plainVars, 6, plainItems);
+  printf("value: drawMenu() %.2f us with TeenyMenuValue<int> items, %.2f us with TeenyMenuItem int items\n\n",
+         typedUs, plainUs);
+  for (int i=0; i<6; i++) {
+    delete typedItems[i];
+    delete plainItems[i];
+  }
+}
@@ -0,0 +1,87 @@
+/*
+Arduino.h - Minimal Arduino core shim for building TeenyMenu on a host (env:native).
+Only what the library and the host tools use is provided.
+*/
+
+#ifndef TEENYMENU_NATIVE_ARDUINO_H
+#define TEENYMENU_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+// On the host int32_t is the same type as int, so the int32_t overloads of TeenyMenuItem collapse into the int ones
+#define TEENYMENU_INT32T_IS_INT
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+template <class A, class B>
+inline auto min(const A& a, const B& b) -> decltype(a < b ? a : b) { return (a < b) ? a : b; }
+template <class A, class B>
+inline auto max(const A& a, const B& b) -> decltype(a > b ? a : b) { return (a > b) ? a : b; }
+
+template <class A, class B, class C>
+inline A constrain(const A& x, const B& a, const C& b) { return (x < a) ? a : (x > b) ? b : x; }
+
+inline uint32_t micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t millis() {
+  return micros() / 1000;
+}
+
+// Durations in TeenyMenu stats (TEENYMENU_STATS) are measured in nanoseconds on the host
+inline uint32_t nativeStatsClock() {
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+#define TEENYMENU_STATS_CLOCK() nativeStatsClock()
+
+// Number of heap blocks String has allocated so far, so host tools can check for allocation-free code paths
+inline unsigned long& nativeStringAllocations() {
+  static unsigned long count = 0;
+  return count;
+}
+
+// Subset of the Arduino String class
+class String {
+  public:
+    String(const char* str = "") { assign(str, strlen(str)); }
+    String(float val, int prec) {
+      char sz[48];
+      int len = snprintf(sz, sizeof(sz), "%.*f", prec, (double)val);
+      assign(sz, (len < (int)sizeof(sz)) ? len : sizeof(sz)-1);
+    }
+    String(const String& other) { assign(other._buf, other._len); }
+    String& operator=(const String& other) {
+      if (this != &other) { free(_buf); assign(other._buf, other._len); }
+      return *this;
+    }
+    ~String() { free(_buf); }
+    unsigned int length() const { return _len; }
+    const char* c_str() const { return _buf; }
+    void toCharArray(char* buf, unsigned int bufsize) const {
+      if (bufsize == 0) return;
+      unsigned int len = (_len < bufsize-1) ? _len : bufsize-1;
+      memcpy(buf, _buf, len);
+      buf[len] = '\0';
+    }
+  private:
+    char* _buf = nullptr;
+    unsigned int _len = 0;
+    void assign(const char* str, unsigned int len) {
+      _buf = (char*)malloc(len+1);
+      nativeStringAllocations()++;
+      memcpy(_buf, str, len);
+      _buf[len] = '\0';
+      _len = len;
+    }
+};
+
+#endif
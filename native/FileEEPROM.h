@@ -0,0 +1,88 @@
+/*
+FileEEPROM.h - EEPROM stand-in for host builds (env:native), kept in a file.
+Has the read()/update() interface of Arduino EEPROM, so that TeenyMenuStore can be run
+on a host, and counts the writes each byte gets, so that host tools can check the wear.
+Cells that never were written read 0xFF, like erased EEPROM. poke() changes a byte without
+counting it as a write, to mimic a write cut short by a reset.
+*/
+
+#ifndef TEENYMENU_NATIVE_FILEEEPROM_H
+#define TEENYMENU_NATIVE_FILEEEPROM_H
+
+#include <Arduino.h>
+
+class FileEEPROM {
+  public:
+    // Opens 'path' (created if missing) and loads its content, the file is kept 'length_' bytes long
+    FileEEPROM(const char* path, uint16_t length_) : _length(length_) {
+      _data = new uint8_t[_length];
+      _writes = new uint32_t[_length]();
+      memset(_data, 0xFF, _length);
+      _file = fopen(path, "r+b");
+      if (_file != nullptr) {
+        size_t count = fread(_data, 1, _length, _file);
+        (void)count;
+      } else {
+        _file = fopen(path, "w+b");
+      }
+      if (_file != nullptr) {
+        fseek(_file, 0, SEEK_SET);
+        fwrite(_data, 1, _length, _file);
+        fflush(_file);
+      }
+    }
+    ~FileEEPROM() {
+      if (_file != nullptr) {
+        fclose(_file);
+      }
+      delete[] _data;
+      delete[] _writes;
+    }
+    FileEEPROM(const FileEEPROM&) = delete;
+    FileEEPROM& operator=(const FileEEPROM&) = delete;
+
+    uint8_t read(int address) {
+      return (address >= 0 && address < _length) ? _data[address] : 0xFF;
+    }
+    void write(int address, uint8_t value) {
+      if (address < 0 || address >= _length) return;
+      _writes[address]++;
+      _totalWrites++;
+      poke(address, value);
+    }
+    // Writes only if the value differs, like EEPROM.update()
+    void update(int address, uint8_t value) {
+      if (read(address) != value) {
+        write(address, value);
+      }
+    }
+    void poke(int address, uint8_t value) {
+      if (address < 0 || address >= _length) return;
+      _data[address] = value;
+      if (_file != nullptr) {
+        fseek(_file, address, SEEK_SET);
+        fputc(value, _file);
+        fflush(_file);
+      }
+    }
+    uint16_t length() { return _length; }
+
+    // Writes since construction, in all and to the most written byte
+    uint32_t getWrites() { return _totalWrites; }
+    uint32_t getMaxCellWrites() {
+      uint32_t most = 0;
+      for (uint16_t i=0; i<_length; i++) {
+        most = max(most, _writes[i]);
+      }
+      return most;
+    }
+
+  private:
+    FILE* _file;
+    uint8_t* _data;
+    uint32_t* _writes;
+    uint16_t _length;
+    uint32_t _totalWrites = 0;
+};
+
+#endif
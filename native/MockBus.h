@@ -0,0 +1,100 @@
+/*
+MockBus.h - SSD1306 bus emulation for host builds (env:native).
+Takes the command and data bytes TeenyMenu::setFrameBus() sends, applies the column/page
+address window commands (0x21/0x22, horizontal addressing mode) to an emulated display RAM
+and counts transfers, so that host tools can check what reached the display and at what cost.
+*/
+
+#ifndef TEENYMENU_NATIVE_MOCKBUS_H
+#define TEENYMENU_NATIVE_MOCKBUS_H
+
+#include <Arduino.h>
+
+struct MockBusCounters {
+  uint32_t commandWrites = 0;
+  uint32_t commandBytes = 0;
+  uint32_t dataWrites = 0;
+  uint32_t dataBytes = 0;
+};
+
+class MockBus {
+  public:
+    MockBus(int16_t width_ = 128, int16_t height_ = 64) : _width(width_), _pages((height_ + 7) / 8) {
+      _ram = new uint8_t[_width * _pages]();
+      _colEnd = _width - 1;
+      _pageEnd = _pages - 1;
+    }
+    ~MockBus() { delete[] _ram; }
+    MockBus(const MockBus&) = delete;
+    MockBus& operator=(const MockBus&) = delete;
+
+    void command(const uint8_t* bytes, uint16_t count) {
+      counters.commandWrites++;
+      counters.commandBytes += count;
+      for (uint16_t i=0; i<count; i++) {
+        commandByte(bytes[i]);
+      }
+    }
+
+    // Data is written at the address pointer, which wraps within the address window
+    void data(const uint8_t* bytes, uint16_t count) {
+      counters.dataWrites++;
+      counters.dataBytes += count;
+      for (uint16_t i=0; i<count; i++) {
+        _ram[_col + _page * _width] = bytes[i];
+        if (_col < _colEnd) {
+          _col++;
+        } else {
+          _col = _colStart;
+          _page = (_page < _pageEnd) ? _page + 1 : _pageStart;
+        }
+      }
+    }
+
+    const uint8_t* ram() { return _ram; }
+    uint16_t ramSize() { return _width * _pages; }
+
+    void resetCounters() { counters = MockBusCounters(); }
+
+    MockBusCounters counters;
+
+  private:
+    int16_t _width;
+    int16_t _pages;
+    uint8_t* _ram;
+    int16_t _colStart = 0;
+    int16_t _colEnd;
+    int16_t _pageStart = 0;
+    int16_t _pageEnd;
+    int16_t _col = 0;
+    int16_t _page = 0;
+    uint8_t _command = 0;   // Command waiting for its arguments
+    uint8_t _args[2];
+    byte _argsCount = 0;
+
+    void commandByte(uint8_t b) {
+      if (_command == 0) {
+        if (b == 0x21 || b == 0x22) {
+          _command = b;
+          _argsCount = 0;
+        }
+        return;
+      }
+      _args[_argsCount++] = b;
+      if (_argsCount < 2) {
+        return;
+      }
+      if (_command == 0x21) {
+        _colStart = _args[0] % _width;
+        _colEnd = _args[1] % _width;
+        _col = _colStart;
+      } else {
+        _pageStart = _args[0] % _pages;
+        _pageEnd = _args[1] % _pages;
+        _page = _pageStart;
+      }
+      _command = 0;
+    }
+};
+
+#endif
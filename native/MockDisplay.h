@@ -0,0 +1,92 @@
+/*
+MockDisplay.h - Recording display for host builds (env:native).
+Implements the subset of the Adafruit GFX/SSD1306 interface used by TeenyMenu<T>
+and counts calls and printed characters. Text is not drawn, rectangles, lines and
+clearDisplay() are drawn into an SSD1306 style 1bpp frame buffer returned by
+getBuffer() (for TeenyMenu::setFrameBuffer()).
+*/
+
+#ifndef TEENYMENU_NATIVE_MOCKDISPLAY_H
+#define TEENYMENU_NATIVE_MOCKDISPLAY_H
+
+#include <Arduino.h>
+
+struct MockDisplayCounters {
+  uint32_t print = 0;
+  uint32_t chars = 0;
+  uint32_t setCursor = 0;
+  uint32_t drawRect = 0;
+  uint32_t drawLine = 0;
+  uint32_t fillRect = 0;
+  uint32_t clearDisplay = 0;
+  uint32_t display = 0;
+};
+
+class MockDisplay {
+  public:
+    MockDisplay(int16_t width_ = 128, int16_t height_ = 64) : _width(width_), _height(height_) {
+      _buffer = new uint8_t[_width * ((_height + 7) / 8)]();
+    }
+    ~MockDisplay() { delete[] _buffer; }
+    MockDisplay(const MockDisplay&) = delete;
+    MockDisplay& operator=(const MockDisplay&) = delete;
+
+    int16_t width() { return _width; }
+    int16_t height() { return _height; }
+
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; counters.setCursor++; }
+    size_t print(const char* str) {
+      size_t len = strlen(str);
+      counters.print++;
+      counters.chars += len;
+      _cursorX += len * 6;
+      return len;
+    }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+      counters.drawRect++;
+      fill(x, y, w, 1, color);
+      fill(x, y+h-1, w, 1, color);
+      fill(x, y, 1, h, color);
+      fill(x+w-1, y, 1, h, color);
+    }
+    // Horizontal and vertical lines only, as used by TeenyMenu
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+      counters.drawLine++;
+      fill(min(x0, x1), min(y0, y1), abs(x1-x0)+1, abs(y1-y0)+1, color);
+    }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+      counters.fillRect++;
+      fill(x, y, w, h, color);
+    }
+    void clearDisplay() {
+      counters.clearDisplay++;
+      memset(_buffer, 0, _width * ((_height + 7) / 8));
+    }
+    void display() { counters.display++; }
+    uint8_t* getBuffer() { return _buffer; }
+
+    void resetCounters() { counters = MockDisplayCounters(); }
+
+    MockDisplayCounters counters;
+
+  private:
+    int16_t _width;
+    int16_t _height;
+    int16_t _cursorX = 0;
+    int16_t _cursorY = 0;
+    uint8_t* _buffer;
+
+    void fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+      for (int16_t j=max(y, 0); j<min(y+h, _height); j++) {
+        for (int16_t i=max(x, 0); i<min(x+w, _width); i++) {
+          if (color) {
+            _buffer[i + (j / 8) * _width] |= (1 << (j & 7));
+          } else {
+            _buffer[i + (j / 8) * _width] &= ~(1 << (j & 7));
+          }
+        }
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,37 @@
+/*
+MockStream.h - In-memory stream for host builds (env:native).
+Has the available()/read()/print() interface of Arduino Stream, so that TeenyMenuRemote
+can be driven on a host: feed() queues input, output collects what was printed.
+*/
+
+#ifndef TEENYMENU_NATIVE_MOCKSTREAM_H
+#define TEENYMENU_NATIVE_MOCKSTREAM_H
+
+#include <Arduino.h>
+#include <string>
+
+class MockStream {
+  public:
+    void feed(const char* str) {
+      if (_inputPos == _input.size()) {
+        _input.clear();
+        _inputPos = 0;
+      }
+      _input += str;
+    }
+    int available() { return (int)(_input.size() - _inputPos); }
+    int read() { return (_inputPos < _input.size()) ? (uint8_t)_input[_inputPos++] : -1; }
+    size_t print(const char* str) {
+      size_t len = strlen(str);
+      output.append(str, len);
+      return len;
+    }
+
+    std::string output;
+
+  private:
+    std::string _input;
+    size_t _inputPos = 0;
+};
+
+#endif
@@ -3,7 +3,9 @@
 
 #include <TeenyPrtVal.h>
 #include "TeenyMenuPage.h"
+#include "TeenyMenuIndex.h"
 #include "TeenyMenuSelect.h"
+#include "TeenyMenuValue.h"
 #include "TeenyMenuConstants.h"
 
 // Macro constants (aliases) for the keys (buttons) used to navigate and interact with menu
@@ -15,6 +17,98 @@ enum teenyMenu_key_t : byte {
   TEENYMENU_KEY_LEFT  = 4  // Left key is pressed (navigate to the previous (parent) menu page, exit without saving the variable or select option)
 };
 
+// Capacity of the key event queue filled by TeenyMenu::queueKeyPress() (one slot is kept free)
+#ifndef TEENYMENU_KEY_QUEUE_LEN
+#define TEENYMENU_KEY_QUEUE_LEN 16
+#endif
+
+// Count of the rows of the screen (from the top) whose values refreshValues() keeps track of (32 at most)
+#ifndef TEENYMENU_VALUE_CACHE_ROWS
+#define TEENYMENU_VALUE_CACHE_ROWS 8
+#endif
+
+// Longest value field (see menuItemValueLength_ of TeenyMenu) whose formatted text is kept per row, so that redrawing
+// an unchanged value doesn't format it again (longer fields are formatted each time they are drawn)
+#ifndef TEENYMENU_VALUE_CACHE_LEN
+#define TEENYMENU_VALUE_CACHE_LEN 10
+#endif
+
+// Runs of up to this many unchanged columns between changed ones are resent rather than starting a new
+// address window (see TeenyMenu::setFrameBus())
+#ifndef TEENYMENU_BUS_SPAN_GAP
+#define TEENYMENU_BUS_SPAN_GAP 8
+#endif
+
+// Count of parent pages a menu remembers to go back to (see TeenyMenuNav), pages entered deeper than that record their
+// parent on the page (see TeenyMenuPage::setParentMenuPage()), so that Back goes up from any depth
+#ifndef TEENYMENU_NAV_DEPTH
+#define TEENYMENU_NAV_DEPTH 8
+#endif
+
+// Cursor of TeenyMenuNav not set yet, the page's default item (see TeenyMenuPage::getDefaultItemNum()) is focused
+#define TEENYMENU_NAV_UNSET ((teenyMenu_row_t)-1)
+
+// Declaration of TeenyMenuNav type: navigation state of a menu, kept apart from the menu pages so that several menus
+// (e.g. on different displays) browse the same pages independently, each with its own TeenyMenuNav, or show the same
+// navigation on several displays, sharing one TeenyMenuNav (see TeenyMenu::setNavigation())
+struct TeenyMenuNav {
+  TeenyMenuPage* page = nullptr;                   // Current page
+  teenyMenu_row_t cursor = TEENYMENU_NAV_UNSET;    // Current item of the page, by its index among all items (or row of virtual page)
+  TeenyMenuPage* parents[TEENYMENU_NAV_DEPTH];     // Breadcrumb: pages the current page was entered from, the last one being its parent
+  teenyMenu_row_t parentCursors[TEENYMENU_NAV_DEPTH];  // Current item of each of these pages
+  byte depth = 0;                                  // Count of parents
+  uint16_t depthBeyond = 0;                        // Count of pages entered beyond the breadcrumb, going back from them
+                                                   // goes to the parent recorded on the page (with its default item focused)
+  uint16_t version = 0;                            // Incremented on every change
+  boolean editValueMode = false;                   // Value of the current item is being edited
+  byte editValueType = 0;
+  int64_t editValue = 0;                           // As passed to TeenyMenuValueOps for TEENYMENU_VAL_TYPED items
+  int editValueSelectNum = -1;
+};
+
+// Display bus write used by TeenyMenu::setFrameBus() (command bytes or display RAM data bytes)
+typedef void (*teenyMenu_busWrite_t)(const uint8_t* bytes, uint16_t count);
+
+// Define TEENYMENU_STATS to have TeenyMenu count what it draws and time it (see TeenyMenu::getStats())
+// TEENYMENU_STATS_CLOCK() - time source of the measured durations (micros() unless defined otherwise)
+#ifdef TEENYMENU_STATS
+#ifndef TEENYMENU_STATS_CLOCK
+#define TEENYMENU_STATS_CLOCK() micros()
+#endif
+
+// Duration samples in TEENYMENU_STATS_CLOCK() ticks
+struct TeenyMenuTiming {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+
+  void add(uint32_t ticks) {
+    if (count == 0 || ticks < min) min = ticks;
+    if (ticks > max) max = ticks;
+    count++;
+    total += ticks;
+  }
+
+  uint32_t avg() const {
+    return (count > 0) ? (uint32_t)(total / count) : 0;
+  }
+};
+
+struct TeenyMenuStats {
+  uint32_t drawMenuCalls;     // Full redraws (drawMenu())
+  uint32_t partialRedraws;    // Redraws of changed rows only (see TeenyMenu::setPartialRedraw())
+  uint32_t itemsDrawn;        // Menu item rows drawn by either
+  uint32_t charsPrinted;      // Characters printed or blitted
+  uint32_t valuesFormatted;   // Values formatted to be drawn
+  uint32_t valuesCached;      // Values drawn from their formatted text kept for the row
+  uint32_t flushes;           // flushDisplay() calls (display() or frames sent over the bus)
+  TeenyMenuTiming render;     // Drawing of a full or partial redraw, without its flush
+  TeenyMenuTiming flush;      // flushDisplay()
+  TeenyMenuTiming keyToFlush; // From registerKeyPress()/processKeys() to the end of the flush it caused
+};
+#endif
+
 // Macro constants (aliases) for some of the ASCII character codes
 #define TEENYMENU_CHAR_CODE_ARROWRIGHT 0x10
 #define TEENYMENU_CHAR_CODE_ARROWLEFT 0x11
@@ -31,6 +125,8 @@ class TeenyMenuItem;
 /********************************************************************/
 template <class T>
 class TeenyMenu {
+  template <class U, class S>
+  friend class TeenyMenuRemote;
 
 /********************************************************************/
     /* PUBLIC */
@@ -78,8 +174,41 @@ class TeenyMenu {
       _white = 1;
       _black = 0;
       _menuIsEmbedded = false;
-      _editValueMode = false;
-      _editValueSelectNum = -1;
+      _nav = &_navOwn;
+      _navVersion = 0;
+      _partialRedraw = false;
+      _redrawAll = true;
+      _dirtyRows = 0;
+      _dirtyValue = false;
+      _rowValuesValid = 0;
+      _titleDrawn = nullptr;
+      _titleLength = 0;
+      _drawnPage = nullptr;
+      _drawnFirstItemNum = 0;
+      _rowScroll = false;
+      _redrawDeferred = false;
+      _redrawPending = false;
+      _keyQueueHead = 0;
+      _keyQueueTail = 0;
+      _editRepeatInterval = 250;
+      _editRepeatsPerStep = 8;
+      _editRepeatKey = TEENYMENU_KEY_NONE;
+      _editRepeatCount = 0;
+      _editRepeatTime = 0;
+      _busShadow = nullptr;
+      _busCommand = nullptr;
+      _busData = nullptr;
+      _busSynced = false;
+      _busFront = nullptr;
+      _busChunk = 0;
+      _busSending = false;
+      _busFramePending = false;
+      _busSendAll = false;
+      _busPage = 0;
+      _busColumn = 0;
+#ifdef TEENYMENU_STATS
+      resetStats();
+#endif
     }
 
 /********************************************************************/
@@ -88,6 +217,72 @@ class TeenyMenu {
     void setTextColor(uint16_t white, uint16_t black) {
       _white = white;
       _black = black;
+      if (_displayPV.getFrameBuffer() != nullptr) {
+        setFrameBuffer(_displayPV.getFrameBuffer());
+      }
+    }
+
+    // Draw menu text straight into the display's page-organized 1bpp frame buffer (SSD1306 layout),
+    // e.g. setFrameBuffer(display.getBuffer()), instead of through print() of the display
+    // Text is drawn with text size 1 as opaque 6x8 cells, inverted if the white color set by setTextColor() is 0
+    // Pass nullptr to go back to print()
+    void setFrameBuffer(uint8_t* frameBuffer) {
+      _displayPV.setFrameBuffer(frameBuffer, _display.width(), _display.height(), _white == 0);
+      _busSynced = false;
+    }
+
+    // If set - frames are sent by flushDisplay() straight over the display bus instead of through display(),
+    // and only the frame buffer bytes (see setFrameBuffer()) that changed since the last frame sent go out
+    // Each changed span of a page is sent as an SSD1306 column/page address window (commands 0x21, 0x22,
+    // horizontal addressing mode) through 'busCommand', followed by its bytes through 'busData'
+    // 'shadowBuffer' - as large as the frame buffer, keeps a copy of the last frame sent
+    // The first frame is sent whole. Pass nullptr to go back to display()
+    void setFrameBus(uint8_t* shadowBuffer, teenyMenu_busWrite_t busCommand, teenyMenu_busWrite_t busData) {
+      _busShadow = shadowBuffer;
+      _busCommand = busCommand;
+      _busData = busData;
+      _busSynced = false;
+      _busSending = false;
+      _busFramePending = false;
+    }
+
+    // If 'frontBuffer' is set - flushDisplay() doesn't send the frame (requires setFrameBus()), but marks it
+    // as ready, and service() sends it in chunks of up to 'chunkBytes' data bytes per call
+    // When a transfer starts, the frame buffer (the back buffer the menu renders into) is copied to
+    // 'frontBuffer' (as large as the frame buffer), so the menu can render the next frame meanwhile
+    // Frames rendered while a transfer is in progress are dropped, except the latest, which is sent next
+    // Pass nullptr to send frames from flushDisplay() again
+    void setFrameBusAsync(uint8_t* frontBuffer, uint16_t chunkBytes) {
+      _busFront = frontBuffer;
+      _busChunk = (chunkBytes > 0) ? chunkBytes : 1;
+      _busSending = false;
+      _busFramePending = false;
+      _busSynced = false;
+    }
+
+    // service() must be called from loop() when setFrameBusAsync() is set, it starts sending the latest frame
+    // or continues sending the current one, at most the chunk size set by setFrameBusAsync() per call
+    // Returns isFlushBusy()
+    bool service() {
+      if (_busFront == nullptr || _busShadow == nullptr || _displayPV.getFrameBuffer() == nullptr) {
+        return(false);
+      }
+      if (!_busSending && _busFramePending) {
+        memcpy(_busFront, _displayPV.getFrameBuffer(), _display.width() * ((_display.height() + 7) / 8));
+        _busFramePending = false;
+        _busSending = true;
+        _busSendAll = !_busSynced;
+        _busSynced = true;
+      }
+      if (_busSending && sendFrameSpans(_busFront, _busChunk)) {
+        _busSending = false;
+      }
+      return(isFlushBusy());
+    }
+
+    // Returns true while a frame is being sent or waits to be sent by service()
+    bool isFlushBusy() {
+      return(_busSending || _busFramePending);
     }
 
     void setMenuEmbedded(bool menuIsEmbedded) {
@@ -98,41 +293,280 @@ class TeenyMenu {
       return(_menuIsEmbedded);
     }
 
+    // If _partialRedraw=true - key presses that stay within the current screen only clear and redraw
+    // the rows (or the value cell being edited) that changed, instead of the whole frame.
+    // Crossing a screen boundary or changing the page still results in a full redraw.
+    // Requires the display to implement fillRect(); has no effect when the menu is embedded.
+    // Call drawMenu() after hiding/showing items or changing linked variables outside of the menu.
+    void setPartialRedraw(bool partialRedraw) {
+      _partialRedraw = partialRedraw;
+      _redrawAll = true;
+    }
+
+    bool isPartialRedraw() {
+      return(_partialRedraw);
+    }
+
+    // If _rowScroll=true - the screen scrolls by single rows to keep the current menu item in view, instead of
+    // paging by whole screens, and the scrollbar shows the share and position of the items on screen
+    // With partial redraw and a frame buffer (see setFrameBuffer()), scrolling moves the rows already drawn in the
+    // frame buffer by whole rows and only draws the rows exposed, the title is left alone and the scrollbar redrawn;
+    // otherwise (or if the rows span more than 64 pixel rows of the display) the menu is drawn whole
+    void setRowScroll(bool rowScroll) {
+      _rowScroll = rowScroll;
+      _redrawAll = true;
+    }
+
+    bool isRowScroll() {
+      return(_rowScroll);
+    }
+
+    // Timing of accelerated editing of menu items with edit steps (see TeenyMenuItem::setEditSteps())
+    // @param 'repeatInterval' - max time in ms between presses of the same key for them to count as a repeat (default 250)
+    // @param 'repeatsPerStep' - count of repeats after which the next (larger) step size is used (default 8)
+    void setEditAcceleration(uint16_t repeatInterval, byte repeatsPerStep) {
+      _editRepeatInterval = repeatInterval;
+      _editRepeatsPerStep = (repeatsPerStep > 0) ? repeatsPerStep : 1;
+    }
+
     // Set supplied menu page as current
-        void setMenuPageCurrent(TeenyMenuPage& menuPageCurrent) {
-      _menuPageCurrent = &menuPageCurrent;
+    // If the page is one of the pages the current page was entered from, go back to it (keeping its current item),
+    // otherwise start browsing from the page, with its default item focused
+    void setMenuPageCurrent(TeenyMenuPage& menuPageCurrent) {
+      if (_nav->page != &menuPageCurrent) {
+        while (_nav->depthBeyond > 0 && _nav->page != &menuPageCurrent) {
+          _nav->depthBeyond--;
+          _nav->page = _nav->page->getParentMenuPage();
+          _nav->cursor = TEENYMENU_NAV_UNSET;
+        }
+        while (_nav->depth > 0 && _nav->page != &menuPageCurrent) {
+          _nav->depth--;
+          _nav->page = _nav->parents[_nav->depth];
+          _nav->cursor = _nav->parentCursors[_nav->depth];
+        }
+        if (_nav->page != &menuPageCurrent) {
+          _nav->page = &menuPageCurrent;
+          _nav->cursor = TEENYMENU_NAV_UNSET;
+        }
+        _nav->editValueMode = false;
+      }
+      _nav->version++;
+    }
+
+    // Navigation state of the menu, its own unless set by setNavigation()
+    TeenyMenuNav& getNavigation() {
+      return(*_nav);
+    }
+
+    // Browse with the supplied navigation state, e.g. getNavigation() of another menu to mirror it on this menu's display
+    // Key presses handled by any of the menus sharing 'nav' move all of them; the menu that handled them redraws itself,
+    // the others are redrawn by syncNavigation()
+    void setNavigation(TeenyMenuNav& nav) {
+      _nav = &nav;
+      _redrawAll = true;
+    }
+
+    // Redraw the menu if its navigation state (see setNavigation()) was changed by another menu since it was drawn
+    // Call it from loop() for the menus that mirror another one
+    // Returns true if the menu was drawn
+    bool syncNavigation() {
+      if (!_redrawAll && _navVersion == _nav->version) {
+        return(false);
+      }
+      drawMenu();
+      return(true);
+    }
+
+    // Current menu item of the current page (or row of virtual page)
+    teenyMenu_row_t getCurrentItemNum() {
+      if (_nav->cursor == TEENYMENU_NAV_UNSET) {
+        _nav->cursor = _nav->page->getItemCursor(_nav->page->getDefaultItemNum());
+      }
+      return(_nav->page->getCursorItemNum(_nav->cursor));
+    }
+
+    // Text of the menu item (or row of virtual page) with supplied index of the current page as it is drawn,
+    // without padding: title, then ':' (or '=' if readonly) and the value for value items (the value being edited
+    // for the current item in edit mode), " >" after links, "< " before Back, "* " before buttons
+    // 'buf' must hold len+1 characters. Returns false past the last row
+    bool getRowText(teenyMenu_row_t itemNum, char* buf, byte len) {
+      if (itemNum >= _nav->page->getRowsCount()) {
+        return(false);
+      }
+      buf[0] = '\0';
+      if (_nav->page->_rows != nullptr) {
+        _nav->page->_rows->text(itemNum, buf, len);
+        buf[len] = '\0';
+        return(true);
+      }
+      TeenyMenuItem* menuItemTmp = _nav->page->getMenuItem(itemNum);
+      const char* title = menuItemTmp->title;
+      const char* prefix = "";
+      const char* suffix = "";
+      char value[32];
+      byte valueLength = min((int)_menuItemValueLength, (int)sizeof(value)-1);
+      value[0] = '\0';
+      switch (menuItemTmp->type) {
+        case TEENYMENU_ITEM_VAL:
+          suffix = menuItemTmp->readonly ? "=" : ":";
+          if (_nav->editValueMode && menuItemTmp == getCurrentMenuItem() &&
+              menuItemTmp->linkedType != TEENYMENU_VAL_BOOLEAN) {
+            if (menuItemTmp->linkedType == TEENYMENU_VAL_SELECT) {
+              TeenyPrtVal<T>::fmt_str(value, valueLength, menuItemTmp->var.select->getOptionNameByIndex(_nav->editValueSelectNum));
+            } else {
+              formatMenuItemValue(menuItemTmp, _nav->editValue, value, valueLength);
+            }
+          } else {
+            formatMenuItemValue(menuItemTmp, getMenuItemValue(menuItemTmp), value, valueLength);
+          }
+          break;
+        case TEENYMENU_ITEM_LINK:
+          suffix = " >";
+          break;
+        case TEENYMENU_ITEM_BACK:
+          prefix = "< ";
+          title = "exit";
+          break;
+        case TEENYMENU_ITEM_BUTTON:
+          prefix = "* ";
+          break;
+      }
+      // Values are drawn padded to their cell
+      for (int i=strlen(value)-1; i>=0 && value[i]==' '; i--) {
+        value[i] = '\0';
+      }
+      const char* parts[] = { prefix, title, suffix, value };
+      byte textLength = 0;
+      for (const char* part : parts) {
+        while (*part != '\0' && textLength < len) {
+          buf[textLength++] = *part++;
+        }
+      }
+      buf[textLength] = '\0';
+      return(true);
+    }
+
+    // Value of the variable linked to the value item with supplied index of the current page (the option index
+    // for a select). Returns false if the item is not a value item, or its value is not an int32_t integer
+    // (see TeenyMenuValue)
+    bool getRowValue(teenyMenu_row_t itemNum, int32_t& value) {
+      if (itemNum >= _nav->page->getRowsCount() || _nav->page->_rows != nullptr) {
+        return(false);
+      }
+      TeenyMenuItem* menuItemTmp = _nav->page->getMenuItem(itemNum);
+      if (menuItemTmp->type != TEENYMENU_ITEM_VAL) {
+        return(false);
+      }
+      int64_t itemValue = getMenuItemValue(menuItemTmp);
+      if ((menuItemTmp->linkedType == TEENYMENU_VAL_TYPED && !menuItemTmp->var.ops->integer) ||
+          itemValue != (int32_t)itemValue) {
+        return(false);
+      }
+      value = itemValue;
+      return(true);
     }
 
     // Get current menu page
     TeenyMenuPage getMenuPageCurrent() {
-      return *_menuPageCurrent;
+      return *_nav->page;
     }
 
     bool isMenuPageCurrent(TeenyMenuPage& menuPageCurrent) {
-      return(_menuPageCurrent==&menuPageCurrent);
+      return(_nav->page==&menuPageCurrent);
     }
 
+    // Enter supplied menu page, the current page becomes the page it goes back to
+    // Deeper than TEENYMENU_NAV_DEPTH pages, the current page is recorded as the parent of the page entered instead
+    // (see TeenyMenuPage::setParentMenuPage()), without its current item
     void linkMenuPage(TeenyMenuPage& menuPageLink) {
+      bool batch = beginRedrawBatch();
       TeenyMenuPage* _menuPageLink = &menuPageLink;
       if (_menuPageLink->enterAction != nullptr) {
         _menuPageLink->enterAction();
       }
-      _menuPageLink->setParentMenuPage(*_menuPageCurrent);
-      _menuPageCurrent = _menuPageLink;
+      if (_nav->depth < TEENYMENU_NAV_DEPTH) {
+        _nav->parents[_nav->depth] = _nav->page;
+        _nav->parentCursors[_nav->depth] = _nav->cursor;
+        _nav->depth++;
+      } else {
+        _menuPageLink->setParentMenuPage(*_nav->page);
+        _nav->depthBeyond++;
+      }
+      _nav->page = _menuPageLink;
       resetMenu();
-      drawMenu();
+      redrawMenu();
+      endRedrawBatch(batch);
     }
 
+    // Go back to the page the current page was entered from or, if none, to its parent set by setParentMenuPage()
     bool exitToParentMenuPage() {
-      if (_menuPageCurrent->getParentMenuPage()!=nullptr) {
+      if (_nav->depth > 0 || _nav->page->getParentMenuPage()!=nullptr) {
+        bool batch = beginRedrawBatch();
         resetMenu();
-        _menuPageCurrent = _menuPageCurrent->getParentMenuPage();
-        drawMenu();
+        if (_nav->depthBeyond > 0) {
+          _nav->depthBeyond--;
+          _nav->page = _nav->page->getParentMenuPage();
+        } else if (_nav->depth > 0) {
+          _nav->depth--;
+          _nav->page = _nav->parents[_nav->depth];
+          _nav->cursor = _nav->parentCursors[_nav->depth];
+        } else {
+          _nav->page = _nav->page->getParentMenuPage();
+        }
+        _redrawAll = true;
+        redrawMenu();
+        endRedrawBatch(batch);
         return(true);
       }
       return(false);
     }
 
+    // Go straight to the item or page with supplied path in 'index' (see TeenyMenuIndex): to the page of the item,
+    // with the item focused (the default item for a readonly item, as readonly items are never focused), or to the
+    // page, with its default item focused; the pages on the path become the pages the current page was entered from,
+    // so that Back goes up the path. Enter actions of the pages are not called
+    // The menu is drawn once. Returns false if the path is not in the index
+    bool navigateTo(TeenyMenuIndex& index, const char* path) {
+      uint16_t len = strlen(path);
+      bool toPage = (len == 0 || path[len-1] == '/');
+      int entryNum = toPage ? index.findPageEntry(path) : index.findEntry(path, len);
+      if (entryNum < 0 || (!toPage && entryNum == 0)) {
+        return(false);
+      }
+      bool batch = beginRedrawBatch();
+      if (_nav->editValueMode) {
+        exitEditValueMode();
+      }
+      // Link items on the way from the root page, the last one first
+      uint16_t linkEntryNum = toPage ? entryNum : index._entries[entryNum].parent;
+      uint16_t depth = 0;
+      for (uint16_t i=linkEntryNum; i!=0; i=index._entries[i].parent) {
+        depth++;
+      }
+      // The breadcrumb keeps the pages closest to the root page, pages deeper than that record their parent
+      _nav->depth = min((int)depth, TEENYMENU_NAV_DEPTH);
+      _nav->depthBeyond = depth - _nav->depth;
+      uint16_t level = depth;
+      for (uint16_t i=linkEntryNum; i!=0; i=index._entries[i].parent) {
+        level--;
+        TeenyMenuPage* parentPage = index.getLinkedPage(index._entries[i].parent);
+        if (level < _nav->depth) {
+          _nav->parents[level] = parentPage;
+          _nav->parentCursors[level] = index._entries[i].indexTotal;
+        } else {
+          index.getLinkedPage(i)->setParentMenuPage(*parentPage);
+        }
+      }
+      _nav->page = index.getLinkedPage(linkEntryNum);
+      _nav->cursor = (toPage || index._entries[entryNum].item->readonly) ? TEENYMENU_NAV_UNSET :
+                     index._entries[entryNum].indexTotal;
+      _nav->version++;
+      _redrawAll = true;
+      redrawMenu();
+      endRedrawBatch(batch);
+      return(true);
+    }
+
 /********************************************************************/
     /* DRAW OPERATIONS */
 /********************************************************************/
@@ -140,139 +574,260 @@ class TeenyMenu {
     // If _menuIsEmbedded=false - Clear the display first, draw menu into display buffer, then display
     // If _menuIsEmbedded=true - Just draw the menu into the display buffer
     void drawMenu() {
+#ifdef TEENYMENU_STATS
+      uint32_t renderStart = TEENYMENU_STATS_CLOCK();
+      _stats.drawMenuCalls++;
+#endif
+      if (_drawnPage != _nav->page) {
+        _rowValuesValid = 0;
+      }
+      _drawnFirstItemNum = getFirstItemNum();
+      _drawnPage = _nav->page;
+      _navVersion = _nav->version;
       if(!_menuIsEmbedded) _display.clearDisplay();
       drawTitleBar();
       drawMenuItems();
       drawScrollbar();
       drawMenuPointer();
-      if(!_menuIsEmbedded) _display.display();
+#ifdef TEENYMENU_STATS
+      _stats.render.add(TEENYMENU_STATS_CLOCK() - renderStart);
+#endif
+      if(!_menuIsEmbedded) flushDisplay();
+      _dirtyRows = 0;
+      _dirtyValue = false;
+      _redrawAll = false;
     }
 
     void drawTitleBar() {
-      _displayPV.prt_str(_menuPageCurrent->title, strlen(_menuPageCurrent->title),
-                         (_display.width()-(strlen(_menuPageCurrent->title)*6))/2, 0);
+      if (_titleDrawn != _nav->page->title) {
+        _titleDrawn = _nav->page->title;
+        _titleLength = strlen(_titleDrawn);
+      }
+      _displayPV.prt_str(_titleDrawn, _titleLength, (_display.width()-(_titleLength*6))/2, 0);
     }
 
     void drawMenuPointer() {
-      if (_menuPageCurrent->getCurrentMenuItem()->readonly) {
-        _menuPageCurrent->resetCurrentItemNum();
+      if (_nav->page->itemsCount>0 && getCurrentMenuItem()->readonly) {
+        _nav->cursor = _nav->page->getItemCursor(_nav->page->getDefaultItemNum());
       }
-      if (_menuPageCurrent->itemsCount>0 &&
-          !_menuPageCurrent->getCurrentMenuItem()->readonly) {
+      if (_nav->page->getRowsCount()>0 && !isCurrentItemReadonly()) {
         int pointerPosition = getCurrentItemTopOffset();
         _display.drawRect(0, pointerPosition+1, 2, _menuItemHeight-3, _white);
       }
     }
 
     void drawMenuItems() {
-      byte currentPageScreenNum = _menuPageCurrent->currentItemNum / _menuItemsPerScreen;
-      TeenyMenuItem* menuItemTmp = (_menuPageCurrent)->getMenuItem(currentPageScreenNum * _menuItemsPerScreen);
-      byte i = 0;
+      teenyMenu_row_t firstItemNum = getFirstItemNum();
+      teenyMenu_row_t rowsCount = _nav->page->getRowsCount();
       byte yOffset = _menuFirstItemScreenTopOffset;
-      while (menuItemTmp != 0 && i < _menuItemsPerScreen) {
-        switch (menuItemTmp->type) {
-          case TEENYMENU_ITEM_VAL:
-            if (menuItemTmp->readonly) {
-              _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength, _menuItemTitleLeftOffset, yOffset);
-              _displayPV.prt_char('=', 1);
-            } else {
-              _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength, _menuItemTitleLeftOffset, yOffset);
-              _displayPV.prt_char(':', 1);
-            }
-            switch (menuItemTmp->linkedType) {
-              case TEENYMENU_VAL_BYTE:
-                if (_editValueMode && menuItemTmp == _menuPageCurrent->getCurrentMenuItem()) {
-                  _displayPV.prt_int(_editValue, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                  _displayPV.prt_char(TEENYMENU_CHAR_CODE_SELECTARROWS, 1, _display.width()-_fontWidth-1, yOffset);
-                } else {
-                  _displayPV.prt_int(*(int*)menuItemTmp->linkedVariable, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                }
-                break;
-              case TEENYMENU_VAL_INTEGER:
-                if (_editValueMode && menuItemTmp == _menuPageCurrent->getCurrentMenuItem()) {
-                  _displayPV.prt_int(_editValue, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                  _displayPV.prt_char(TEENYMENU_CHAR_CODE_SELECTARROWS, 1, _display.width()-_fontWidth-1, yOffset);
-                } else {
-                  _displayPV.prt_int(*(int*)menuItemTmp->linkedVariable, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                }
-                break;
-              case TEENYMENU_VAL_INT32T:
-                if (_editValueMode && menuItemTmp == _menuPageCurrent->getCurrentMenuItem()) {
-                  _displayPV.prt_int(_editValue, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                  _displayPV.prt_char(TEENYMENU_CHAR_CODE_SELECTARROWS, 1, _display.width()-_fontWidth-1, yOffset);
-                } else {
-                  _displayPV.prt_int(*(int*)menuItemTmp->linkedVariable, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                }
-                break;
-              case TEENYMENU_VAL_BOOLEAN:
-                if (*(boolean*)menuItemTmp->linkedVariable) {
-                  _displayPV.prt_str("TRUE", _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                } else {
-                  _displayPV.prt_str("FALSE", _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                }
-                break;
-              case TEENYMENU_VAL_SELECT:
-                TeenyMenuSelect* select = menuItemTmp->select;
-                if (_editValueMode && menuItemTmp == _menuPageCurrent->getCurrentMenuItem()) {
-                  _displayPV.prt_str(select->getOptionNameByIndex(_editValueSelectNum), _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                  _displayPV.prt_char(TEENYMENU_CHAR_CODE_SELECTARROWS, 1, _display.width()-_fontWidth-1, yOffset);
-                } else {
-                  _displayPV.prt_str(select->getSelectedOptionName(menuItemTmp->linkedVariable), _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
-                }
-                break;
-            }
-            break;
-          case TEENYMENU_ITEM_LINK:
-            if (menuItemTmp->readonly) {
-              _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+1, _menuItemTitleLeftOffset, yOffset);
-            } else {
-              _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+1, _menuItemTitleLeftOffset, yOffset);
-            }
-            _displayPV.prt_char(TEENYMENU_CHAR_CODE_ARROWRIGHT, 1, _display.width()-_fontWidth-1, yOffset);
-            break;
-          case TEENYMENU_ITEM_BACK:
-            _displayPV.prt_char(TEENYMENU_CHAR_CODE_ARROWLEFT, 1, _menuItemTitleLeftOffset, yOffset);
-            _displayPV.prt_str("exit", 4, _menuItemTitleLeftOffset+6, yOffset);
-            break;
-          case TEENYMENU_ITEM_BUTTON:
-            _displayPV.prt_char(TEENYMENU_CHAR_CODE_BULLET, 1, _menuItemTitleLeftOffset, yOffset);
-            if (menuItemTmp->readonly) {
-              _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+2, _menuItemTitleLeftOffset+6, yOffset);
-            } else {
-              _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+2, _menuItemTitleLeftOffset+6, yOffset);
-            }
-            break;
-          case TEENYMENU_ITEM_LABEL:
-            _displayPV.prt_str(menuItemTmp->title, _menuItemLabelLength, _menuItemLabelLeftOffset, yOffset);
-            break;
-        }
-        menuItemTmp = menuItemTmp->getMenuItemNext();
+      for (byte i=0; i<_menuItemsPerScreen && firstItemNum+i<rowsCount; i++) {
+        drawMenuRow(firstItemNum + i, yOffset);
         yOffset += _menuItemHeight;
-        i++;
+      }
+    }
+
+    // Draw the menu item (or row of virtual page) with supplied index at the row starting at yOffset
+    void drawMenuRow(teenyMenu_row_t itemNum, byte yOffset) {
+      if (_nav->page->_rows == nullptr) {
+        drawMenuItem(_nav->page->getMenuItem(itemNum), yOffset);
+        return;
+      }
+#ifdef TEENYMENU_STATS
+      _stats.itemsDrawn++;
+#endif
+      // Rows of virtual page are laid out like links, the text is asked from the page only for rows on screen
+      char sz[32];
+      byte len = min((int)_menuItemTitleLength+_menuItemValueLength+1, (int)sizeof(sz)-1);
+      sz[0] = '\0';
+      _nav->page->_rows->text(itemNum, sz, len);
+      sz[len] = '\0';
+      _displayPV.prt_str(sz, len, _menuItemTitleLeftOffset, yOffset);
+    }
+
+    // Draw a single menu item (title and value) at the row starting at yOffset
+    void drawMenuItem(TeenyMenuItem* menuItemTmp, byte yOffset) {
+#ifdef TEENYMENU_STATS
+      _stats.itemsDrawn++;
+#endif
+      switch (menuItemTmp->type) {
+        case TEENYMENU_ITEM_VAL:
+          if (menuItemTmp->readonly) {
+            _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength, _menuItemTitleLeftOffset, yOffset);
+            _displayPV.prt_char('=', 1);
+          } else {
+            _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength, _menuItemTitleLeftOffset, yOffset);
+            _displayPV.prt_char(':', 1);
+          }
+          drawMenuItemValue(menuItemTmp, yOffset);
+          break;
+        case TEENYMENU_ITEM_LINK:
+          if (menuItemTmp->readonly) {
+            _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+1, _menuItemTitleLeftOffset, yOffset);
+          } else {
+            _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+1, _menuItemTitleLeftOffset, yOffset);
+          }
+          _displayPV.prt_char(TEENYMENU_CHAR_CODE_ARROWRIGHT, 1, _display.width()-_fontWidth-1, yOffset);
+          break;
+        case TEENYMENU_ITEM_BACK:
+          _displayPV.prt_char(TEENYMENU_CHAR_CODE_ARROWLEFT, 1, _menuItemTitleLeftOffset, yOffset);
+          _displayPV.prt_str("exit", 4, _menuItemTitleLeftOffset+6, yOffset);
+          break;
+        case TEENYMENU_ITEM_BUTTON:
+          _displayPV.prt_char(TEENYMENU_CHAR_CODE_BULLET, 1, _menuItemTitleLeftOffset, yOffset);
+          if (menuItemTmp->readonly) {
+            _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+2, _menuItemTitleLeftOffset+6, yOffset);
+          } else {
+            _displayPV.prt_str(menuItemTmp->title, _menuItemTitleLength+_menuItemValueLength+2, _menuItemTitleLeftOffset+6, yOffset);
+          }
+          break;
+        case TEENYMENU_ITEM_LABEL:
+          _displayPV.prt_str(menuItemTmp->title, _menuItemLabelLength, _menuItemLabelLeftOffset, yOffset);
+          break;
+      }
+    }
+
+    // Draw the value cell (starting at _menuItemValueLeftOffset) of a TEENYMENU_ITEM_VAL menu item
+    void drawMenuItemValue(TeenyMenuItem* menuItemTmp, byte yOffset) {
+      if (_nav->editValueMode && menuItemTmp == getCurrentMenuItem() &&
+          menuItemTmp->linkedType != TEENYMENU_VAL_BOOLEAN) {
+        if (menuItemTmp->linkedType == TEENYMENU_VAL_SELECT) {
+          _displayPV.prt_str(menuItemTmp->var.select->getOptionNameByIndex(_nav->editValueSelectNum), _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
+        } else if (menuItemTmp->linkedType == TEENYMENU_VAL_TYPED) {
+          char sz[32];
+          formatMenuItemValue(menuItemTmp, _nav->editValue, sz, min((int)_menuItemValueLength, (int)sizeof(sz)-1));
+          _displayPV.prt_buf(sz, _menuItemValueLeftOffset, yOffset);
+        } else {
+          _displayPV.prt_int(_nav->editValue, _menuItemValueLength, _menuItemValueLeftOffset, yOffset);
+        }
+        _displayPV.prt_char(TEENYMENU_CHAR_CODE_SELECTARROWS, 1, _display.width()-_fontWidth-1, yOffset);
+        uncacheMenuItemValue(yOffset);
+        return;
+      }
+      int64_t value = getMenuItemValue(menuItemTmp);
+      byte row = getCacheRow(yOffset);
+      if (row < TEENYMENU_VALUE_CACHE_ROWS && _menuItemValueLength <= TEENYMENU_VALUE_CACHE_LEN) {
+        if (!(_rowValuesValid & ((uint32_t)1 << row)) || _rowItems[row] != menuItemTmp || _rowValues[row] != value) {
+          formatMenuItemValue(menuItemTmp, value, _rowText[row], _menuItemValueLength);
+          _rowItems[row] = menuItemTmp;
+          _rowValues[row] = value;
+          _rowValuesValid |= (uint32_t)1 << row;
+        }
+#ifdef TEENYMENU_STATS
+        else {
+          _stats.valuesCached++;
+        }
+#endif
+        _displayPV.prt_buf(_rowText[row], _menuItemValueLeftOffset, yOffset);
+      } else {
+        char sz[32];
+        formatMenuItemValue(menuItemTmp, value, sz, min((int)_menuItemValueLength, (int)sizeof(sz)-1));
+        _displayPV.prt_buf(sz, _menuItemValueLeftOffset, yOffset);
+        uncacheMenuItemValue(yOffset);
       }
     }
 
     void drawScrollbar() {
-      byte screensCount = ((_menuPageCurrent->itemsCount % _menuItemsPerScreen)==0) ?
-                              _menuPageCurrent->itemsCount / _menuItemsPerScreen :
-                              _menuPageCurrent->itemsCount / _menuItemsPerScreen + 1;
+      teenyMenu_row_t rowsCount = _nav->page->getRowsCount();
+      teenyMenu_row_t screensCount = ((rowsCount % _menuItemsPerScreen)==0) ?
+                                         rowsCount / _menuItemsPerScreen :
+                                         rowsCount / _menuItemsPerScreen + 1;
       if(screensCount > 1) {
-        byte currentScreenNum = _menuPageCurrent->currentItemNum / _menuItemsPerScreen;
+        teenyMenu_row_t currentScreenNum = getCurrentItemNum() / _menuItemsPerScreen;
       //byte scrollbarHeight = (_display.height() - _menuFirstItemScreenTopOffset) / screensCount;
-        byte scrollbarHeight = (_menuItemHeight * _menuItemsPerScreen) / screensCount;
+        uint16_t scrollbarArea = _menuItemHeight * _menuItemsPerScreen;
+        byte scrollbarHeight = scrollbarArea / screensCount;
         byte scrollbarPosition = (currentScreenNum * scrollbarHeight) + _menuFirstItemScreenTopOffset;
+        if (_rowScroll) {
+          // As tall as the share of the items on screen, as far down as the share of the items above them
+          scrollbarHeight = max((uint32_t)scrollbarArea * _menuItemsPerScreen / rowsCount, (uint32_t)1);
+          scrollbarPosition = (uint32_t)getFirstItemNum() * (scrollbarArea - scrollbarHeight) / (rowsCount - _menuItemsPerScreen) +
+                              _menuFirstItemScreenTopOffset;
+        } else if (scrollbarHeight == 0) {
+          // With more screens than pixels the scrollbar is a single pixel spread over the whole area
+          scrollbarHeight = 1;
+          scrollbarPosition = (uint32_t)currentScreenNum * (scrollbarArea - 1) / (screensCount - 1) + _menuFirstItemScreenTopOffset;
+        }
         // draw scrollbar at last pixel column = _display.width()-1
         _display.drawLine(_display.width()-1, scrollbarPosition,
                           _display.width()-1, scrollbarPosition+scrollbarHeight-1, _white);
       }
     }
 
-    // Exit _editValueMode if needed and set first item as current item
+    // refreshValues() redraws the value cells of the visible TEENYMENU_ITEM_VAL items whose linked variable (or
+    // selected option) changed since they were drawn, and flushes the display only if any did, so that it can be
+    // called often to keep items showing live variables up to date (e.g. readonly sensor readings)
+    // Only the first TEENYMENU_VALUE_CACHE_ROWS rows are refreshed, the value being edited is left alone
+    // Requires the display to implement fillRect(); call it from loop(), not from menu actions
+    // Returns true if any value was redrawn
+    bool refreshValues() {
+      if (_drawnPage != _nav->page || _redrawAll || _drawnFirstItemNum != getFirstItemNum()) {
+        return(false);
+      }
+      bool changed = false;
+      teenyMenu_row_t firstItemNum = _drawnFirstItemNum;
+      for (byte i=0; i<_menuItemsPerScreen && i<TEENYMENU_VALUE_CACHE_ROWS && firstItemNum+i<_nav->page->itemsCount; i++) {
+        TeenyMenuItem* menuItemTmp = _nav->page->getMenuItem(firstItemNum + i);
+        if (menuItemTmp->type != TEENYMENU_ITEM_VAL ||
+            (_nav->editValueMode && menuItemTmp == getCurrentMenuItem())) {
+          continue;
+        }
+        if ((_rowValuesValid & ((uint32_t)1 << i)) && _rowItems[i] == menuItemTmp &&
+            _rowValues[i] == getMenuItemValue(menuItemTmp)) {
+          continue;
+        }
+        redrawMenuItemValue(menuItemTmp, _menuFirstItemScreenTopOffset + i * _menuItemHeight);
+        changed = true;
+      }
+      if (changed && !_menuIsEmbedded) {
+        flushDisplay();
+      }
+      return(changed);
+    }
+
+    // Send the frame to the display, only its changed spans if setFrameBus() is set, otherwise with display()
+    // With setFrameBusAsync() only mark the frame as ready to be sent by service()
+    // Called by the menu unless it is embedded
+    void flushDisplay() {
+#ifdef TEENYMENU_STATS
+      uint32_t flushStart = TEENYMENU_STATS_CLOCK();
+      sendFrame();
+      uint32_t flushEnd = TEENYMENU_STATS_CLOCK();
+      _stats.flushes++;
+      _stats.flush.add(flushEnd - flushStart);
+      if (_statsKeyPending) {
+        _statsKeyPending = false;
+        _stats.keyToFlush.add(flushEnd - _statsKeyStart);
+      }
+#else
+      sendFrame();
+#endif
+    }
+
+#ifdef TEENYMENU_STATS
+    // Counters and durations collected since the last resetStats(), e.g. to be printed over serial
+    TeenyMenuStats getStats() {
+      TeenyMenuStats stats = _stats;
+      stats.charsPrinted = _displayPV.getCharCount();
+      return(stats);
+    }
+
+    void resetStats() {
+      memset(&_stats, 0, sizeof(_stats));
+      _displayPV.resetCharCount();
+      _statsKeyPending = false;
+    }
+#endif
+
+    // Exit edit value mode if needed and set default item as current item
     void resetMenu() {
-      if(_editValueMode) {
+      bool batch = beginRedrawBatch();
+      if(_nav->editValueMode) {
         exitEditValueMode();
       }
-      _menuPageCurrent->resetCurrentItemNum();
+      _nav->cursor = TEENYMENU_NAV_UNSET;
+      _nav->version++;
+      _redrawAll = true;
+      endRedrawBatch(batch);
     }
 
 /********************************************************************/
@@ -282,9 +837,70 @@ class TeenyMenu {
     // Register the key press and trigger corresponding action
     // Accepts TEENYMENU_KEY_NONE, TEENYMENU_KEY_UP, TEENYMENU_KEY_RIGHT, TEENYMENU_KEY_DOWN,
     // TEENYMENU_KEY_LEFT, TEENYMENU_KEY_CANCEL, TEENYMENU_KEY_OK values
+    // The menu is drawn at most once, after the key press has been handled
     void registerKeyPress(byte keyCode) {
+#ifdef TEENYMENU_STATS
+      statsKeyStart();
+#endif
+      bool batch = beginRedrawBatch();
       _currentKey = keyCode;
       dispatchKeyPress();
+      endRedrawBatch(batch);
+#ifdef TEENYMENU_STATS
+      if (batch) {
+        _statsKeyPending = false;
+      }
+#endif
+    }
+
+    // queueKeyPress() stores the key press to be handled later by processKeys()
+    // Safe to call from an interrupt handler (e.g. rotary encoder) while loop() calls processKeys()
+    // Returns false if the queue is full and the key press was dropped
+    bool queueKeyPress(byte keyCode) {
+      byte head = (_keyQueueHead + 1) % TEENYMENU_KEY_QUEUE_LEN;
+      if (head == _keyQueueTail) {
+        return(false);
+      }
+      _keyQueue[_keyQueueHead] = keyCode;
+      _keyQueueHead = head;
+      return(true);
+    }
+
+    // processKeys() handles all queued key presses and draws the menu once at the end
+    // Consecutive TEENYMENU_KEY_UP/TEENYMENU_KEY_DOWN presses are collapsed into their net movement
+    // (opposite presses cancel out), both when navigating items and when editing a value
+    void processKeys() {
+      if (_keyQueueHead == _keyQueueTail) {
+        return;
+      }
+#ifdef TEENYMENU_STATS
+      statsKeyStart();
+#endif
+      bool batch = beginRedrawBatch();
+      while (_keyQueueHead != _keyQueueTail) {
+        byte keyCode = popKeyPress();
+        if ((keyCode == TEENYMENU_KEY_UP || keyCode == TEENYMENU_KEY_DOWN) &&
+            (_nav->editValueMode || _nav->page->getRowsCount() > 0)) {
+          int steps = (keyCode == TEENYMENU_KEY_DOWN) ? 1 : -1;
+          while (_keyQueueHead != _keyQueueTail &&
+                 (_keyQueue[_keyQueueTail] == TEENYMENU_KEY_UP || _keyQueue[_keyQueueTail] == TEENYMENU_KEY_DOWN)) {
+            steps += (popKeyPress() == TEENYMENU_KEY_DOWN) ? 1 : -1;
+          }
+          _currentKey = (steps > 0) ? TEENYMENU_KEY_DOWN : TEENYMENU_KEY_UP;
+          for (int i=abs(steps); i>0; i--) {
+            dispatchKeyPress();
+          }
+        } else {
+          _currentKey = keyCode;
+          dispatchKeyPress();
+        }
+      }
+      endRedrawBatch(batch);
+#ifdef TEENYMENU_STATS
+      if (batch) {
+        _statsKeyPending = false;
+      }
+#endif
     }
 
 /********************************************************************/
@@ -315,9 +931,9 @@ class TeenyMenu {
 
     // Private so usr cant infinite loop with page exitAction
     bool exitMenuPage() {
-      if (_menuPageCurrent->exitAction != nullptr) {
+      if (_nav->page->exitAction != nullptr) {
         resetMenu();
-        _menuPageCurrent->exitAction();
+        _nav->page->exitAction();
         return(true);
       }
       return(exitToParentMenuPage());
@@ -326,62 +942,501 @@ class TeenyMenu {
 /********************************************************************/
     /* DRAW OPERATIONS */
 /********************************************************************/
-    TeenyMenuPage* _menuPageCurrent;
     TeenyMenuItem* _menuItemCurrent;
     byte getCurrentItemTopOffset() {
-      return ((_menuPageCurrent->currentItemNum % _menuItemsPerScreen) * _menuItemHeight) +
+      return ((getCurrentItemNum() - getFirstItemNum()) * _menuItemHeight) +
               _menuFirstItemScreenTopOffset;
     }
 
+    // First menu item on screen: the one starting the screen that holds the current item or, with setRowScroll(),
+    // the one drawn first last time, moved by as few rows as needed to show the current item
+    teenyMenu_row_t getFirstItemNum() {
+      teenyMenu_row_t currentItemNum = getCurrentItemNum();
+      if (!_rowScroll) {
+        return((currentItemNum / _menuItemsPerScreen) * _menuItemsPerScreen);
+      }
+      teenyMenu_row_t firstItemNum = (_drawnPage == _nav->page) ? _drawnFirstItemNum : 0;
+      if (currentItemNum < firstItemNum) {
+        firstItemNum = currentItemNum;
+      } else if (currentItemNum - firstItemNum >= _menuItemsPerScreen) {
+        firstItemNum = currentItemNum - _menuItemsPerScreen + 1;
+      }
+      // Keep the screen full when items below it were removed or hidden
+      teenyMenu_row_t rowsCount = _nav->page->getRowsCount();
+      if (rowsCount <= _menuItemsPerScreen) {
+        firstItemNum = 0;
+      } else if (firstItemNum > rowsCount - _menuItemsPerScreen) {
+        firstItemNum = rowsCount - _menuItemsPerScreen;
+      }
+      return(firstItemNum);
+    }
+
+    // Navigation state (see setNavigation())
+    TeenyMenuNav _navOwn;
+    TeenyMenuNav* _nav;
+    uint16_t _navVersion;           // _nav->version drawn last
+
+    TeenyMenuItem* getCurrentMenuItem() {
+      return(_nav->page->getMenuItem(getCurrentItemNum()));
+    }
+
+    void setCurrentItemNum(teenyMenu_row_t itemNum) {
+      _nav->cursor = _nav->page->getItemCursor(itemNum);
+    }
+
+    // Rows of virtual pages are never readonly
+    bool isMenuItemReadonly(teenyMenu_row_t itemNum) {
+      TeenyMenuItem* menuItemTmp = _nav->page->getMenuItem(itemNum);
+      return(menuItemTmp != nullptr && menuItemTmp->readonly);
+    }
+
+    bool isCurrentItemReadonly() {
+      return(isMenuItemReadonly(getCurrentItemNum()));
+    }
+
+    // Display bus (see setFrameBus())
+    uint8_t* _busShadow;            // Copy of the last frame sent
+    teenyMenu_busWrite_t _busCommand;
+    teenyMenu_busWrite_t _busData;
+    bool _busSynced;                // _busShadow matches the display, otherwise the next frame is sent whole
+    uint8_t* _busFront;             // Frame being sent by service() (see setFrameBusAsync())
+    uint16_t _busChunk;             // Max data bytes sent per service() call
+    bool _busSending;               // service() is sending _busFront
+    bool _busFramePending;          // The frame buffer holds a frame not sent yet
+    bool _busSendAll;               // Send the frame being sent whole, not only its changed spans
+    byte _busPage;                  // Page and column the frame being sent is compared from
+    int16_t _busColumn;
+
+    // Send the changed spans of 'frame' from _busPage/_busColumn on, stopping once 'budget' data bytes went out
+    // (the span reaching it is cut there and the rest is sent by the next call)
+    // Returns true when the whole frame is sent
+    bool sendFrameSpans(const uint8_t* frame, uint32_t budget) {
+      int16_t width = _display.width();
+      byte pages = (_display.height() + 7) / 8;
+      while (_busPage < pages) {
+        const uint8_t* row = frame + _busPage * width;
+        uint8_t* shadow = _busShadow + _busPage * width;
+        int16_t x = _busColumn;
+        while (x < width && !_busSendAll && row[x] == shadow[x]) {
+          x++;
+        }
+        if (x == width) {
+          _busPage++;
+          _busColumn = 0;
+          continue;
+        }
+        if (budget == 0) {
+          _busColumn = x;
+          return(false);
+        }
+        int16_t start = x;
+        int16_t end = x;
+        for (x++; x < width && x - end <= TEENYMENU_BUS_SPAN_GAP; x++) {
+          if (_busSendAll || row[x] != shadow[x]) {
+            end = x;
+          }
+        }
+        if ((uint32_t)(end - start + 1) > budget) {
+          end = start + budget - 1;
+        }
+        sendFrameSpan(_busPage, _busPage, start, end, row + start);
+        memcpy(shadow + start, row + start, end - start + 1);
+        budget -= end - start + 1;
+        _busColumn = end + 1;
+      }
+      _busPage = 0;
+      _busColumn = 0;
+      _busSendAll = false;
+      return(true);
+    }
+
+    // Send the frame for flushDisplay()
+    void sendFrame() {
+      uint8_t* frame = _displayPV.getFrameBuffer();
+      if (_busShadow == nullptr || frame == nullptr) {
+        _display.display();
+        return;
+      }
+      if (_busFront != nullptr) {
+        _busFramePending = true;
+        return;
+      }
+      if (!_busSynced) {
+        int16_t width = _display.width();
+        byte pages = (_display.height() + 7) / 8;
+        sendFrameSpan(0, pages-1, 0, width-1, frame);
+        memcpy(_busShadow, frame, width * pages);
+        _busSynced = true;
+        return;
+      }
+      _busPage = 0;
+      _busColumn = 0;
+      sendFrameSpans(frame, UINT32_MAX);
+    }
+
+    // Send frame buffer bytes 'data' of the window spanning pages pageStart..pageEnd and columns colStart..colEnd
+    void sendFrameSpan(byte pageStart, byte pageEnd, int16_t colStart, int16_t colEnd, const uint8_t* data) {
+      const uint8_t window[] = { 0x21, (uint8_t)colStart, (uint8_t)colEnd, 0x22, pageStart, pageEnd };
+      _busCommand(window, sizeof(window));
+      _busData(data, (colEnd - colStart + 1) * (pageEnd - pageStart + 1));
+    }
+
+    // Dirty-region tracking (see setPartialRedraw())
+    bool _partialRedraw;
+    bool _rowScroll;                // Scroll by rows (see setRowScroll())
+    bool _redrawAll;                // Next redraw must be a full drawMenu()
+    uint32_t _dirtyRows;            // Bit n set - row n of the screen drawn last needs redraw
+    bool _dirtyValue;               // Value cell of the current menu item needs redraw
+    TeenyMenuPage* _drawnPage;      // Menu page drawn last by drawMenu()
+    teenyMenu_row_t _drawnFirstItemNum;  // First menu item on screen, as drawn last
+
+    // Height of the band of the frame buffer the rows are drawn in, clipped to the display
+    int16_t getRowsBandHeight() {
+      return(min((int)_menuItemHeight * _menuItemsPerScreen, (int)_display.height() - _menuFirstItemScreenTopOffset));
+    }
+
+    // Rows on screen can be moved in the frame buffer to start at firstItemNum (see shiftMenuRows()) if the ones
+    // drawn last stay partly on screen and their band spans at most 8 pages
+    bool canShiftMenuRows(teenyMenu_row_t firstItemNum) {
+      teenyMenu_row_t rows = (firstItemNum > _drawnFirstItemNum) ? firstItemNum - _drawnFirstItemNum : _drawnFirstItemNum - firstItemNum;
+      int16_t top = _menuFirstItemScreenTopOffset;
+      return(_rowScroll && _displayPV.getFrameBuffer() != nullptr && rows < _menuItemsPerScreen &&
+             (top + getRowsBandHeight() - 1) / 8 - top / 8 < 8);
+    }
+
+    // Scroll the rows on screen to start at firstItemNum: move the rows drawn in the frame buffer, together with
+    // their formatted values and dirty flags, mark the rows exposed dirty and redraw the scrollbar
+    void shiftMenuRows(teenyMenu_row_t firstItemNum) {
+      // rows > 0 - rows move down the screen
+      int rows = (firstItemNum > _drawnFirstItemNum) ? -(int)(firstItemNum - _drawnFirstItemNum) : (int)(_drawnFirstItemNum - firstItemNum);
+      int16_t top = _menuFirstItemScreenTopOffset;
+      int16_t height = getRowsBandHeight();
+      shiftFrameBand(top, height, rows * _menuItemHeight);
+      shiftValueCache(rows);
+      uint32_t screenRows = (_menuItemsPerScreen == 32) ? 0xFFFFFFFF : ((uint32_t)1 << _menuItemsPerScreen) - 1;
+      uint32_t exposedRows;
+      if (rows > 0) {
+        _dirtyRows <<= rows;
+        exposedRows = ((uint32_t)1 << rows) - 1;
+      } else {
+        _dirtyRows >>= -rows;
+        exposedRows = screenRows & ~(screenRows >> -rows);
+      }
+      _dirtyRows = (_dirtyRows & screenRows) | exposedRows;
+      _drawnFirstItemNum = firstItemNum;
+      // The scrollbar column moved along with the rows
+      _display.fillRect(_display.width() - 1, top, 1, height, _black);
+      drawScrollbar();
+    }
+
+    // Move the pixels of the frame buffer rows top..top+height-1 down by dy pixels (up if dy is negative),
+    // the band spanning at most 8 pages; pixels exposed are left as they were
+    void shiftFrameBand(int16_t top, int16_t height, int16_t dy) {
+      uint8_t* frame = _displayPV.getFrameBuffer();
+      int16_t width = _display.width();
+      byte pageFirst = top / 8;
+      byte pageLast = (top + height - 1) / 8;
+      if (top % 8 == 0 && height % 8 == 0 && dy % 8 == 0) {
+        // Page-aligned band, move whole pages
+        uint8_t* band = frame + pageFirst * width;
+        int16_t pagesMoved = (height - abs(dy)) / 8;
+        if (dy > 0) {
+          memmove(band + (dy / 8) * width, band, pagesMoved * width);
+        } else {
+          memmove(band, band - (dy / 8) * width, pagesMoved * width);
+        }
+        return;
+      }
+      // Otherwise move each column of the band as a whole
+      byte offset = top - pageFirst * 8;
+      uint64_t mask = (height >= 64) ? ~(uint64_t)0 : (((uint64_t)1 << height) - 1) << offset;
+      for (int16_t x=0; x<width; x++) {
+        uint64_t column = 0;
+        for (byte p=pageFirst; p<=pageLast; p++) {
+          column |= (uint64_t)frame[p * width + x] << ((p - pageFirst) * 8);
+        }
+        uint64_t moved = (dy > 0) ? (column << dy) : (column >> -dy);
+        column = (column & ~mask) | (moved & mask);
+        for (byte p=pageFirst; p<=pageLast; p++) {
+          frame[p * width + x] = (uint8_t)(column >> ((p - pageFirst) * 8));
+        }
+      }
+    }
+
+    // Clear and draw the value cell of the menu item at the row starting at yOffset (the scrollbar column is left untouched)
+    void redrawMenuItemValue(TeenyMenuItem* menuItemTmp, byte yOffset) {
+      _display.fillRect(_menuItemValueLeftOffset, yOffset, _display.width() - 1 - _menuItemValueLeftOffset, _menuItemHeight, _black);
+      drawMenuItemValue(menuItemTmp, yOffset);
+    }
+
+    // Values last drawn in the rows of the screen (see refreshValues()) and their formatted text
+    TeenyMenuItem* _rowItems[TEENYMENU_VALUE_CACHE_ROWS];
+    int64_t _rowValues[TEENYMENU_VALUE_CACHE_ROWS];
+    char _rowText[TEENYMENU_VALUE_CACHE_ROWS][TEENYMENU_VALUE_CACHE_LEN+1];
+    uint32_t _rowValuesValid;       // Bit n set - row n holds the value of _rowItems[n] drawn last
+    const char* _titleDrawn;        // Title drawn last and its length
+    byte _titleLength;
+
+    // Value of the variable linked to a TEENYMENU_ITEM_VAL menu item as compared by refreshValues()
+    // (the option index for a select, see TeenyMenuValueOps for TEENYMENU_VAL_TYPED)
+    int64_t getMenuItemValue(TeenyMenuItem* menuItemTmp) {
+      switch (menuItemTmp->linkedType) {
+        case TEENYMENU_VAL_BYTE:
+          return(*(byte*)menuItemTmp->var.linkedVariable);
+        case TEENYMENU_VAL_INTEGER:
+          return(*(int*)menuItemTmp->var.linkedVariable);
+        case TEENYMENU_VAL_INT32T:
+          return(*(int32_t*)menuItemTmp->var.linkedVariable);
+        case TEENYMENU_VAL_BOOLEAN:
+          return(*(boolean*)menuItemTmp->var.linkedVariable);
+        case TEENYMENU_VAL_SELECT:
+          return(menuItemTmp->var.select->getSelectedOptionNum(menuItemTmp->var.linkedVariable));
+        case TEENYMENU_VAL_TYPED:
+          return(menuItemTmp->var.ops->get(menuItemTmp->var.linkedVariable));
+      }
+      return(0);
+    }
+
+    // Row of the screen starting at yOffset, TEENYMENU_VALUE_CACHE_ROWS if the row has no cache entry
+    byte getCacheRow(byte yOffset) {
+      byte row = (yOffset - _menuFirstItemScreenTopOffset) / _menuItemHeight;
+      if (yOffset < _menuFirstItemScreenTopOffset || row >= TEENYMENU_VALUE_CACHE_ROWS) {
+        return(TEENYMENU_VALUE_CACHE_ROWS);
+      }
+      return(row);
+    }
+
+    // Move the formatted values kept per row along with rows moved down by 'rows' (up if negative)
+    void shiftValueCache(int rows) {
+      uint32_t valid = 0;
+      for (int i=0; i<TEENYMENU_VALUE_CACHE_ROWS; i++) {
+        // Fill the rows in the order their sources are not overwritten before being read
+        int row = (rows > 0) ? TEENYMENU_VALUE_CACHE_ROWS - 1 - i : i;
+        int from = row - rows;
+        if (from >= 0 && from < TEENYMENU_VALUE_CACHE_ROWS && (_rowValuesValid & ((uint32_t)1 << from))) {
+          _rowItems[row] = _rowItems[from];
+          _rowValues[row] = _rowValues[from];
+          memcpy(_rowText[row], _rowText[from], TEENYMENU_VALUE_CACHE_LEN+1);
+          valid |= (uint32_t)1 << row;
+        }
+      }
+      _rowValuesValid = valid;
+    }
+
+    void uncacheMenuItemValue(byte yOffset) {
+      byte row = getCacheRow(yOffset);
+      if (row < TEENYMENU_VALUE_CACHE_ROWS) {
+        _rowValuesValid &= ~((uint32_t)1 << row);
+      }
+    }
+
+    // Format 'value' of a TEENYMENU_ITEM_VAL menu item (see getMenuItemValue()) into 'buf' of len+1 characters
+    // the way drawMenuItemValue() draws it
+    void formatMenuItemValue(TeenyMenuItem* menuItemTmp, int64_t value, char* buf, int len) {
+#ifdef TEENYMENU_STATS
+      _stats.valuesFormatted++;
+#endif
+      switch (menuItemTmp->linkedType) {
+        case TEENYMENU_VAL_BOOLEAN:
+          TeenyPrtVal<T>::fmt_str(buf, len, value ? "TRUE" : "FALSE");
+          break;
+        case TEENYMENU_VAL_SELECT:
+          TeenyPrtVal<T>::fmt_str(buf, len, menuItemTmp->var.select->getOptionNameByIndex(value));
+          break;
+        case TEENYMENU_VAL_TYPED:
+          menuItemTmp->var.ops->format(value, buf, len);
+          if (len > 0) {
+            buf[len-1] = ' ';
+          }
+          break;
+        default:
+          TeenyPrtVal<T>::fmt_int(buf, len, value);
+          if (len > 0) {
+            buf[len-1] = ' ';
+          }
+          break;
+      }
+    }
+
+    // Mark the row of the supplied menu item index as needing redraw
+    // With setRowScroll() rows off screen are left alone, they are drawn if scrolled into view
+    void markMenuRowDirty(teenyMenu_row_t itemNum) {
+      if (itemNum >= _drawnFirstItemNum && itemNum - _drawnFirstItemNum < _menuItemsPerScreen) {
+        _dirtyRows |= (uint32_t)1 << (itemNum - _drawnFirstItemNum);
+      } else if (!_rowScroll) {
+        _redrawAll = true;
+      }
+    }
+
+    // Redraws requested between beginRedrawBatch() and endRedrawBatch() only set _redrawPending, and the menu
+    // is drawn once by the outermost endRedrawBatch(), so each key press (or processKeys() call) renders once
+    // no matter how many of the operations it goes through ask for a redraw
+    // Returns whether this call started the batch, to be passed to endRedrawBatch()
+    bool beginRedrawBatch() {
+      bool outermost = !_redrawDeferred;
+      _redrawDeferred = true;
+      return(outermost);
+    }
+
+    void endRedrawBatch(bool outermost) {
+      if (!outermost) {
+        return;
+      }
+      _redrawDeferred = false;
+      if (_redrawPending) {
+        _redrawPending = false;
+        redrawMenu();
+      }
+    }
+
+    // redrawMenu() is used after key presses in place of drawMenu()
+    // Within a redraw batch (see beginRedrawBatch()), only remember that a redraw is needed
+    // If partial redraw is enabled and the current screen is unchanged (or, with setRowScroll(), scrolled by
+    // less than a screen), only clear and redraw the dirty rows/value cell and display, otherwise fall back to drawMenu()
+    void redrawMenu() {
+      _nav->version++;
+      if (_redrawDeferred) {
+        _redrawPending = true;
+        return;
+      }
+      teenyMenu_row_t firstItemNum = getFirstItemNum();
+      bool scrolled = (_drawnPage == _nav->page && firstItemNum != _drawnFirstItemNum);
+      if (!_partialRedraw || _menuIsEmbedded || _redrawAll || _menuItemsPerScreen > 32 ||
+          _drawnPage != _nav->page || (scrolled && !canShiftMenuRows(firstItemNum))) {
+        drawMenu();
+        return;
+      }
+      _navVersion = _nav->version;
+      if (!scrolled && _dirtyRows == 0 && !_dirtyValue) {
+        return;
+      }
+#ifdef TEENYMENU_STATS
+      uint32_t renderStart = TEENYMENU_STATS_CLOCK();
+      _stats.partialRedraws++;
+#endif
+      if (scrolled) {
+        shiftMenuRows(firstItemNum);
+      }
+      int16_t rowWidth = _display.width() - 1;  // Leave the scrollbar column untouched
+      byte currentRowNum = getCurrentItemNum() - firstItemNum;
+      teenyMenu_row_t rowsCount = _nav->page->getRowsCount();
+      for (byte i=0; i<_menuItemsPerScreen; i++) {
+        if (_dirtyRows & ((uint32_t)1 << i)) {
+          byte yOffset = _menuFirstItemScreenTopOffset + i * _menuItemHeight;
+          _display.fillRect(0, yOffset, rowWidth, _menuItemHeight, _black);
+          if (firstItemNum + i < rowsCount) {
+            drawMenuRow(firstItemNum + i, yOffset);
+            if (i == currentRowNum && !isCurrentItemReadonly()) {
+              _display.drawRect(0, yOffset+1, 2, _menuItemHeight-3, _white);
+            }
+          }
+        }
+      }
+      if (_dirtyValue && !(_dirtyRows & ((uint32_t)1 << currentRowNum))) {
+        byte yOffset = getCurrentItemTopOffset();
+        redrawMenuItemValue(getCurrentMenuItem(), yOffset);
+      }
+      _dirtyRows = 0;
+      _dirtyValue = false;
+#ifdef TEENYMENU_STATS
+      _stats.render.add(TEENYMENU_STATS_CLOCK() - renderStart);
+#endif
+      flushDisplay();
+    }
+
 /********************************************************************/
     /* MENU ITEMS NAVIGATION */
 /********************************************************************/
     void nextMenuItem() {
-      if(_menuPageCurrent->itemsCount) {
-        for (byte i=0; i<_menuPageCurrent->itemsCount; i++) {
-          if (_menuPageCurrent->currentItemNum == _menuPageCurrent->itemsCount-1) {
-            if(_menuPageCurrent->keyDownAction != nullptr) {
-              _menuPageCurrent->keyDownAction();
+      TeenyMenuPage* page = _nav->page;
+      teenyMenu_row_t rowsCount = page->getRowsCount();
+      if(rowsCount) {
+        teenyMenu_row_t currentItemNumPrev = getCurrentItemNum();
+        teenyMenu_row_t currentItemNum = currentItemNumPrev;
+        for (teenyMenu_row_t i=0; i<rowsCount; i++) {
+          if (currentItemNum == rowsCount-1) {
+            if(page->keyDownAction != nullptr) {
+              page->keyDownAction();
+              _redrawAll = true;
+              // The callback may have moved the cursor, changed the rows or gone to another page
+              if (_nav->page != page) {
+                redrawMenu();
+                return;
+              }
+              rowsCount = page->getRowsCount();
+              if (rowsCount == 0) {
+                redrawMenu();
+                return;
+              }
+              currentItemNum = getCurrentItemNum();
             } else {
-              _menuPageCurrent->currentItemNum = 0;
+              currentItemNum = 0;
             }
           } else {
-            _menuPageCurrent->currentItemNum++;
+            currentItemNum++;
           }
-          if(!_menuPageCurrent->getCurrentMenuItem()->readonly) {
+          if(!isMenuItemReadonly(currentItemNum)) {
             break;
           }
         }
-        drawMenu();
-      } else if(_menuPageCurrent->keyDownAction != nullptr) {
-        _menuPageCurrent->keyDownAction();
+        setCurrentItemNum(currentItemNum);
+        markMenuRowDirty(currentItemNumPrev);
+        markMenuRowDirty(currentItemNum);
+        redrawMenu();
+      } else if(_nav->page->keyDownAction != nullptr) {
+        _nav->page->keyDownAction();
       }
     }
 
     void prevMenuItem() {
-      if(_menuPageCurrent->itemsCount) {
-        for (byte i=0; i<_menuPageCurrent->itemsCount; i++) {
-          if (_menuPageCurrent->currentItemNum == 0) {
-            if(_menuPageCurrent->keyUpAction != nullptr) {
-              _menuPageCurrent->keyUpAction();
+      TeenyMenuPage* page = _nav->page;
+      teenyMenu_row_t rowsCount = page->getRowsCount();
+      if(rowsCount) {
+        teenyMenu_row_t currentItemNumPrev = getCurrentItemNum();
+        teenyMenu_row_t currentItemNum = currentItemNumPrev;
+        for (teenyMenu_row_t i=0; i<rowsCount; i++) {
+          if (currentItemNum == 0) {
+            if(page->keyUpAction != nullptr) {
+              page->keyUpAction();
+              _redrawAll = true;
+              // The callback may have moved the cursor, changed the rows or gone to another page
+              if (_nav->page != page) {
+                redrawMenu();
+                return;
+              }
+              rowsCount = page->getRowsCount();
+              if (rowsCount == 0) {
+                redrawMenu();
+                return;
+              }
+              currentItemNum = getCurrentItemNum();
             } else {
-              _menuPageCurrent->currentItemNum = _menuPageCurrent->itemsCount-1;
+              currentItemNum = rowsCount-1;
             }
           } else {
-            _menuPageCurrent->currentItemNum--;
+            currentItemNum--;
           }
-          if(!_menuPageCurrent->getCurrentMenuItem()->readonly) {
+          if(!isMenuItemReadonly(currentItemNum)) {
             break;
           }
         }
-        drawMenu();
-      } else if(_menuPageCurrent->keyUpAction != nullptr) {
-        _menuPageCurrent->keyUpAction();
+        setCurrentItemNum(currentItemNum);
+        markMenuRowDirty(currentItemNumPrev);
+        markMenuRowDirty(currentItemNum);
+        redrawMenu();
+      } else if(_nav->page->keyUpAction != nullptr) {
+        _nav->page->keyUpAction();
       }
     }
 
     void menuItemSelect() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
+      if (_nav->page->_rows != nullptr) {
+        if (_nav->page->_rows->select != nullptr && _nav->page->getRowsCount() > 0) {
+          _nav->page->_rows->select(getCurrentItemNum());
+        }
+        return;
+      }
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
       switch (menuItemTmp->type) {
         case TEENYMENU_ITEM_VAL:
           if (!menuItemTmp->readonly) {
@@ -407,169 +1462,235 @@ class TeenyMenu {
 /********************************************************************/
     /* VALUE EDIT */
 /********************************************************************/
-    boolean _editValueMode;
-    byte _editValueType;
-    int _editValue;
-    int _editValueSelectNum;
+    uint16_t _editRepeatInterval;     // Max ms between presses of the same key to count as a repeat (see setEditAcceleration())
+    byte _editRepeatsPerStep;         // Repeats needed to advance to the next edit step size
+    byte _editRepeatKey;              // Key of the last increment/decrement
+    byte _editRepeatCount;            // Consecutive repeats of _editRepeatKey
+    uint32_t _editRepeatTime;         // millis() of the last increment/decrement
 
     void enterEditValueMode() {
-      _editValueMode = true;
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
-      _editValueType = menuItemTmp->linkedType;
-      switch (_editValueType) {
+      _nav->editValueMode = true;
+      _editRepeatKey = TEENYMENU_KEY_NONE;
+      _editRepeatCount = 0;
+      markMenuRowDirty(getCurrentItemNum());
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
+      _nav->editValueType = menuItemTmp->linkedType;
+      switch (_nav->editValueType) {
         case TEENYMENU_VAL_BYTE:
-          _editValue = *(byte*)menuItemTmp->linkedVariable;
-          drawMenu();
+          _nav->editValue = *(byte*)menuItemTmp->var.linkedVariable;
+          redrawMenu();
           break;
         case TEENYMENU_VAL_INTEGER:
-          _editValue = *(int*)menuItemTmp->linkedVariable;
-          drawMenu();
+          _nav->editValue = *(int*)menuItemTmp->var.linkedVariable;
+          redrawMenu();
           break;
         case TEENYMENU_VAL_INT32T:
-          _editValue = *(int32_t*)menuItemTmp->linkedVariable;
-          drawMenu();
+          _nav->editValue = *(int32_t*)menuItemTmp->var.linkedVariable;
+          redrawMenu();
+          break;
+        case TEENYMENU_VAL_TYPED:
+          _nav->editValue = menuItemTmp->var.ops->get(menuItemTmp->var.linkedVariable);
+          redrawMenu();
           break;
         case TEENYMENU_VAL_BOOLEAN:
           checkboxToggle();
-          drawMenu();
+          redrawMenu();
           break;
         case TEENYMENU_VAL_SELECT:
-          TeenyMenuSelect* select = menuItemTmp->select;
-          _editValueSelectNum = select->getSelectedOptionNum(menuItemTmp->linkedVariable);
-          drawMenu();
+          TeenyMenuSelect* select = menuItemTmp->var.select;
+          _nav->editValueSelectNum = select->getSelectedOptionNum(menuItemTmp->var.linkedVariable);
+          redrawMenu();
           break;
       }
     }
 
     void checkboxToggle() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
-      boolean checkboxValue = *(boolean*)menuItemTmp->linkedVariable;
-      *(boolean*)menuItemTmp->linkedVariable = !checkboxValue;
-      if (menuItemTmp->saveAction != nullptr) {
-        menuItemTmp->saveAction();
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
+      boolean checkboxValue = *(boolean*)menuItemTmp->var.linkedVariable;
+      *(boolean*)menuItemTmp->var.linkedVariable = !checkboxValue;
+      if (menuItemTmp->var.saveAction != nullptr) {
+        menuItemTmp->var.saveAction();
+        _redrawAll = true;  // saveAction may have changed anything on the page
         exitEditValueMode();
       } else {
         exitEditValueMode();
       }
     }
 
+    // Step size for the next increment/decrement of the edited value
+    // Without edit steps set on the menu item this is always 1, otherwise each run of _editRepeatsPerStep presses
+    // of the same key, no more than _editRepeatInterval ms apart, advances to the next (larger) step size
+    int32_t getEditStep(TeenyMenuItem* menuItemTmp, byte keyCode) {
+      if (menuItemTmp->getEditSteps() == nullptr || menuItemTmp->getEditStepsCount() == 0) {
+        return(1);
+      }
+      uint32_t now = millis();
+      if (keyCode == _editRepeatKey && now - _editRepeatTime <= _editRepeatInterval) {
+        if (_editRepeatCount < 255) {
+          _editRepeatCount++;
+        }
+      } else {
+        _editRepeatCount = 0;
+      }
+      _editRepeatKey = keyCode;
+      _editRepeatTime = now;
+      byte stepNum = _editRepeatCount / _editRepeatsPerStep;
+      if (stepNum >= menuItemTmp->getEditStepsCount()) {
+        stepNum = menuItemTmp->getEditStepsCount() - 1;
+      }
+      return(menuItemTmp->getEditSteps()[stepNum]);
+    }
+
     void decrementEditValue() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
+      int32_t step = getEditStep(menuItemTmp, TEENYMENU_KEY_DOWN);
+      void* rangeMin = menuItemTmp->getRangeMin();
+      void* rangeMax = menuItemTmp->getRangeMax();
       switch (menuItemTmp->linkedType) {
         case TEENYMENU_VAL_BYTE:
-          if(menuItemTmp->rangeMin!=nullptr && _editValue<=*(byte*)menuItemTmp->rangeMin) {
-            _editValue = *(byte*)menuItemTmp->rangeMin;
-          } else if(menuItemTmp->rangeMax!=nullptr && _editValue>*(byte*)menuItemTmp->rangeMax) {
-            _editValue = *(byte*)menuItemTmp->rangeMax;
+          if(rangeMin!=nullptr && _nav->editValue<=*(byte*)rangeMin) {
+            _nav->editValue = *(byte*)rangeMin;
+          } else if(rangeMax!=nullptr && _nav->editValue>*(byte*)rangeMax) {
+            _nav->editValue = *(byte*)rangeMax;
+          } else if(rangeMin!=nullptr && _nav->editValue-*(byte*)rangeMin<step) {
+            _nav->editValue = *(byte*)rangeMin;
           } else {
-            _editValue--;
+            _nav->editValue -= step;
           }
           break;
         case TEENYMENU_VAL_INTEGER:
-          if(menuItemTmp->rangeMin!=nullptr && _editValue<=*(int*)menuItemTmp->rangeMin) {
-            _editValue = *(int*)menuItemTmp->rangeMin;
-          } else if(menuItemTmp->rangeMax!=nullptr && _editValue>*(int*)menuItemTmp->rangeMax) {
-            _editValue = *(int*)menuItemTmp->rangeMax;
+          if(rangeMin!=nullptr && _nav->editValue<=*(int*)rangeMin) {
+            _nav->editValue = *(int*)rangeMin;
+          } else if(rangeMax!=nullptr && _nav->editValue>*(int*)rangeMax) {
+            _nav->editValue = *(int*)rangeMax;
+          } else if(rangeMin!=nullptr && _nav->editValue-*(int*)rangeMin<step) {
+            _nav->editValue = *(int*)rangeMin;
           } else {
-            _editValue--;
+            _nav->editValue -= step;
           }
           break;
         case TEENYMENU_VAL_INT32T:
-          if(menuItemTmp->rangeMin!=nullptr && _editValue<=*(int32_t*)menuItemTmp->rangeMin) {
-            _editValue = *(int32_t*)menuItemTmp->rangeMin;
-          } else if(menuItemTmp->rangeMax!=nullptr && _editValue>*(int32_t*)menuItemTmp->rangeMax) {
-            _editValue = *(int32_t*)menuItemTmp->rangeMax;
+          if(rangeMin!=nullptr && _nav->editValue<=*(int32_t*)rangeMin) {
+            _nav->editValue = *(int32_t*)rangeMin;
+          } else if(rangeMax!=nullptr && _nav->editValue>*(int32_t*)rangeMax) {
+            _nav->editValue = *(int32_t*)rangeMax;
+          } else if(rangeMin!=nullptr && _nav->editValue-*(int32_t*)rangeMin<step) {
+            _nav->editValue = *(int32_t*)rangeMin;
           } else {
-            _editValue--;
+            _nav->editValue -= step;
           }
-            break;
+          break;
+        case TEENYMENU_VAL_TYPED:
+          _nav->editValue = menuItemTmp->var.ops->step(menuItemTmp, _nav->editValue, -step);
+          break;
       }
-      drawMenu();
+      _dirtyValue = true;
+      redrawMenu();
     }
 
     void incrementEditValue() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
+      int32_t step = getEditStep(menuItemTmp, TEENYMENU_KEY_UP);
+      void* rangeMin = menuItemTmp->getRangeMin();
+      void* rangeMax = menuItemTmp->getRangeMax();
       switch (menuItemTmp->linkedType) {
         case TEENYMENU_VAL_BYTE:
-          if(menuItemTmp->rangeMax!=nullptr && _editValue>=*(byte*)menuItemTmp->rangeMax) {
-            _editValue = *(byte*)menuItemTmp->rangeMax;
-          } else if(menuItemTmp->rangeMin!=nullptr && _editValue<*(byte*)menuItemTmp->rangeMin) {
-            _editValue = *(byte*)menuItemTmp->rangeMin;
+          if(rangeMax!=nullptr && _nav->editValue>=*(byte*)rangeMax) {
+            _nav->editValue = *(byte*)rangeMax;
+          } else if(rangeMin!=nullptr && _nav->editValue<*(byte*)rangeMin) {
+            _nav->editValue = *(byte*)rangeMin;
+          } else if(rangeMax!=nullptr && *(byte*)rangeMax-_nav->editValue<step) {
+            _nav->editValue = *(byte*)rangeMax;
           } else {
-            _editValue++;
+            _nav->editValue += step;
           }
           break;
         case TEENYMENU_VAL_INTEGER:
-          if(menuItemTmp->rangeMax!=nullptr && _editValue>=*(int*)menuItemTmp->rangeMax) {
-            _editValue = *(int*)menuItemTmp->rangeMax;
-          } else if(menuItemTmp->rangeMin!=nullptr && _editValue<*(int*)menuItemTmp->rangeMin) {
-            _editValue = *(int*)menuItemTmp->rangeMin;
+          if(rangeMax!=nullptr && _nav->editValue>=*(int*)rangeMax) {
+            _nav->editValue = *(int*)rangeMax;
+          } else if(rangeMin!=nullptr && _nav->editValue<*(int*)rangeMin) {
+            _nav->editValue = *(int*)rangeMin;
+          } else if(rangeMax!=nullptr && *(int*)rangeMax-_nav->editValue<step) {
+            _nav->editValue = *(int*)rangeMax;
           } else {
-            _editValue++;
+            _nav->editValue += step;
           }
           break;
         case TEENYMENU_VAL_INT32T:
-          if(menuItemTmp->rangeMax!=nullptr && _editValue>=*(int32_t*)menuItemTmp->rangeMax) {
-            _editValue = *(int32_t*)menuItemTmp->rangeMax;
-          } else if(menuItemTmp->rangeMin!=nullptr && _editValue<*(int32_t*)menuItemTmp->rangeMin) {
-            _editValue = *(int32_t*)menuItemTmp->rangeMin;
+          if(rangeMax!=nullptr && _nav->editValue>=*(int32_t*)rangeMax) {
+            _nav->editValue = *(int32_t*)rangeMax;
+          } else if(rangeMin!=nullptr && _nav->editValue<*(int32_t*)rangeMin) {
+            _nav->editValue = *(int32_t*)rangeMin;
+          } else if(rangeMax!=nullptr && *(int32_t*)rangeMax-_nav->editValue<step) {
+            _nav->editValue = *(int32_t*)rangeMax;
           } else {
-            _editValue++;
+            _nav->editValue += step;
           }
           break;
+        case TEENYMENU_VAL_TYPED:
+          _nav->editValue = menuItemTmp->var.ops->step(menuItemTmp, _nav->editValue, step);
+          break;
       }
-      drawMenu();
+      _dirtyValue = true;
+      redrawMenu();
     }
 
     void nextEditValueSelectNum() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
-      TeenyMenuSelect* select = menuItemTmp->select;
-      if (_editValueSelectNum+1 < select->getLength()) {
-        _editValueSelectNum++;
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
+      TeenyMenuSelect* select = menuItemTmp->var.select;
+      if (_nav->editValueSelectNum+1 < select->getLength()) {
+        _nav->editValueSelectNum++;
       } else {
-        _editValueSelectNum = 0;
+        _nav->editValueSelectNum = 0;
       }
-      drawMenu();
+      _dirtyValue = true;
+      redrawMenu();
     }
 
     void prevEditValueSelectNum() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
-      TeenyMenuSelect* select = menuItemTmp->select;
-      if (_editValueSelectNum > 0) {
-        _editValueSelectNum--;
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
+      TeenyMenuSelect* select = menuItemTmp->var.select;
+      if (_nav->editValueSelectNum > 0) {
+        _nav->editValueSelectNum--;
       } else {
-        _editValueSelectNum = select->getLength()-1;
+        _nav->editValueSelectNum = select->getLength()-1;
       }
-      drawMenu();
+      _dirtyValue = true;
+      redrawMenu();
     }
 
     void saveEditValue() {
-      TeenyMenuItem* menuItemTmp = _menuPageCurrent->getCurrentMenuItem();
+      TeenyMenuItem* menuItemTmp = getCurrentMenuItem();
       switch (menuItemTmp->linkedType) {
         case TEENYMENU_VAL_BYTE:
-          *(byte*)menuItemTmp->linkedVariable = _editValue;
+          *(byte*)menuItemTmp->var.linkedVariable = _nav->editValue;
           break;
         case TEENYMENU_VAL_INTEGER:
-          *(int*)menuItemTmp->linkedVariable = _editValue;
+          *(int*)menuItemTmp->var.linkedVariable = _nav->editValue;
           break;
         case TEENYMENU_VAL_INT32T:
-          *(int32_t*)menuItemTmp->linkedVariable = _editValue;
+          *(int32_t*)menuItemTmp->var.linkedVariable = _nav->editValue;
+          break;
+        case TEENYMENU_VAL_TYPED:
+          menuItemTmp->var.ops->set(menuItemTmp->var.linkedVariable, _nav->editValue);
           break;
         case TEENYMENU_VAL_SELECT:
-          TeenyMenuSelect* select = menuItemTmp->select;
-          select->setValue(menuItemTmp->linkedVariable, _editValueSelectNum);
+          TeenyMenuSelect* select = menuItemTmp->var.select;
+          select->setValue(menuItemTmp->var.linkedVariable, _nav->editValueSelectNum);
           break;
       }
-      if (menuItemTmp->saveAction != nullptr) {
-        menuItemTmp->saveAction();
+      if (menuItemTmp->var.saveAction != nullptr) {
+        menuItemTmp->var.saveAction();
+        _redrawAll = true;  // saveAction may have changed anything on the page
       }
       exitEditValueMode();
     }
 
     void exitEditValueMode() {
-      _editValueSelectNum = -1;
-      _editValueMode = false;
-      drawMenu();
+      _nav->editValueSelectNum = -1;
+      _nav->editValueMode = false;
+      markMenuRowDirty(getCurrentItemNum());
+      redrawMenu();
     }
 
 /********************************************************************/
@@ -577,32 +1698,58 @@ class TeenyMenu {
 /********************************************************************/
     byte _currentKey;
 
+    // Key event queue (ring buffer written by queueKeyPress() and read by processKeys())
+    volatile byte _keyQueue[TEENYMENU_KEY_QUEUE_LEN];
+    volatile byte _keyQueueHead;
+    volatile byte _keyQueueTail;
+    bool _redrawDeferred;           // Redraws are postponed until the current redraw batch ends
+    bool _redrawPending;            // A redraw was requested while redraws were postponed
+#ifdef TEENYMENU_STATS
+    TeenyMenuStats _stats;
+    uint32_t _statsKeyStart;        // Start of the key press handled by registerKeyPress()/processKeys()
+    bool _statsKeyPending;          // The key press has not been flushed yet
+
+    // A key press flushed from within another one (e.g. registerKeyPress() from a page action) keeps the outer start
+    void statsKeyStart() {
+      if (!_redrawDeferred) {
+        _statsKeyStart = TEENYMENU_STATS_CLOCK();
+        _statsKeyPending = true;
+      }
+    }
+#endif
+
+    byte popKeyPress() {
+      byte keyCode = _keyQueue[_keyQueueTail];
+      _keyQueueTail = (_keyQueueTail + 1) % TEENYMENU_KEY_QUEUE_LEN;
+      return(keyCode);
+    }
+
     void dispatchKeyPress() {
-      if(_editValueMode) {
+      if(_nav->editValueMode) {
         switch (_currentKey) {
           case TEENYMENU_KEY_UP:
-            if (_editValueType == TEENYMENU_VAL_SELECT) {
+            if (_nav->editValueType == TEENYMENU_VAL_SELECT) {
               prevEditValueSelectNum();
             } else {
               incrementEditValue();
             }
             break;
           case TEENYMENU_KEY_RIGHT:
-            if (_editValueType == TEENYMENU_VAL_SELECT) {
+            if (_nav->editValueType == TEENYMENU_VAL_SELECT) {
               saveEditValue();
             } else {
               saveEditValue();
             }
             break;
           case TEENYMENU_KEY_DOWN:
-            if (_editValueType == TEENYMENU_VAL_SELECT) {
+            if (_nav->editValueType == TEENYMENU_VAL_SELECT) {
               nextEditValueSelectNum();
             } else {
               decrementEditValue();
             }
             break;
           case TEENYMENU_KEY_LEFT:
-            if (_editValueType == TEENYMENU_VAL_SELECT) {
+            if (_nav->editValueType == TEENYMENU_VAL_SELECT) {
               exitEditValueMode();
             } else {
               exitEditValueMode();
@@ -8,4 +8,17 @@
 #define TEENYMENU_VAL_BOOLEAN 3  // Associated variable is of type boolean
 #define TEENYMENU_VAL_SELECT  4  // Associated variable is either of type int, byte or char[] with option select used to pick a predefined value from the list
                                  // (note that char[] array should be big enough to hold select option with the longest value)
+#define TEENYMENU_VAL_TYPED   5  // Associated variable is of the type of a TeenyMenuValue item (see TeenyMenuValue.h)
 
+
+// Macro constant (alias) for placing constant menu items and item arrays in flash
+// Items and arrays are read with plain loads, so PROGMEM is only used on ARM cores, where flash is mapped into the
+// address space (e.g. Teensy 4.x copies plain const data to RAM). Elsewhere constexpr data stays where the toolchain
+// puts const data: flash on most 32 bit cores, RAM on AVR and ESP8266 (which can't read PROGMEM with plain loads)
+#ifndef TEENYMENU_CONST
+#if defined(PROGMEM) && defined(__arm__)
+#define TEENYMENU_CONST PROGMEM
+#else
+#define TEENYMENU_CONST
+#endif
+#endif
@@ -0,0 +1,93 @@
+#ifndef HEADER_TEENYMENUFRAME
+#define HEADER_TEENYMENUFRAME
+
+#include <Arduino.h>
+
+/*
+  Declaration of TeenyMenuFrame class: headless display for TeenyMenu<TeenyMenuFrame>, which renders the menu into
+  a page-organized 1bpp frame buffer (SSD1306 layout) and nothing else, e.g. to run the menu without a screen
+  attached and read it remotely (see TeenyMenuRemote), or to test it on a host
+  Rectangles and lines are drawn into the buffer, text is drawn by the menu itself, so set it up with
+    menu.setFrameBuffer(frame.getBuffer());
+  print() is only called for characters missing from the built-in font, which are left out
+*/
+class TeenyMenuFrame {
+  public:
+    /*
+      @param 'buffer_' - frame buffer of width_ * ((height_ + 7) / 8) bytes
+      @param 'width_', 'height_' (optional) - size of the frame in pixels
+      default 128x64
+    */
+    TeenyMenuFrame(uint8_t* buffer_, int16_t width_ = 128, int16_t height_ = 64)
+      : _buffer(buffer_)
+      , _width(width_)
+      , _height(height_)
+    { }
+
+    int16_t width() {
+      return(_width);
+    }
+
+    int16_t height() {
+      return(_height);
+    }
+
+    uint8_t* getBuffer() {
+      return(_buffer);
+    }
+
+    // Frames completed by the menu (display() calls)
+    uint32_t getFramesCount() {
+      return(_framesCount);
+    }
+
+    void setCursor(int16_t, int16_t) { }
+
+    size_t print(const char* str) {
+      return(strlen(str));
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+      fillRect(x, y, w, 1, color);
+      fillRect(x, y+h-1, w, 1, color);
+      fillRect(x, y, 1, h, color);
+      fillRect(x+w-1, y, 1, h, color);
+    }
+
+    // Horizontal and vertical lines only, as used by TeenyMenu
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+      fillRect(min(x0, x1), min(y0, y1), abs(x1-x0)+1, abs(y1-y0)+1, color);
+    }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+      int16_t xEnd = min(x+w, (int)_width);
+      int16_t yEnd = min(y+h, (int)_height);
+      for (int16_t j=max(y, (int16_t)0); j<yEnd; j++) {
+        uint8_t* column = _buffer + (j / 8) * _width;
+        uint8_t mask = 1 << (j & 7);
+        for (int16_t i=max(x, (int16_t)0); i<xEnd; i++) {
+          if (color) {
+            column[i] |= mask;
+          } else {
+            column[i] &= ~mask;
+          }
+        }
+      }
+    }
+
+    void clearDisplay() {
+      memset(_buffer, 0, _width * ((_height + 7) / 8));
+    }
+
+    void display() {
+      _framesCount++;
+    }
+
+  private:
+    uint8_t* _buffer;
+    int16_t _width;
+    int16_t _height;
+    uint32_t _framesCount = 0;
+};
+
+#endif
@@ -0,0 +1,263 @@
+#include <Arduino.h>
+#include "TeenyMenuIndex.h"
+#include "TeenyMenuSelect.h"
+#include "TeenyMenuConstants.h"
+
+// FNV-1a, over the path as a whole (hashPath() of "A/B" equals hashPath() of "/B" continued from the hash of "A")
+static const uint32_t TEENYMENU_INDEX_HASH_BASIS = 2166136261u;
+static const uint32_t TEENYMENU_INDEX_HASH_PRIME = 16777619u;
+
+// Slots of the hash table are entry numbers in uint16_t, so the table has at most 0x8000 slots (a power of 2), and
+// entries (the root page included) are capped at half of them, so that the table always has empty slots to end probes
+static const uint16_t TEENYMENU_INDEX_SLOTS_MAX = 0x8000;
+static const uint16_t TEENYMENU_INDEX_ENTRIES_MAX = TEENYMENU_INDEX_SLOTS_MAX / 2;
+
+TeenyMenuIndex::TeenyMenuIndex() { }
+
+TeenyMenuIndex::~TeenyMenuIndex() {
+  free(_entries);
+  free(_slots);
+}
+
+boolean TeenyMenuIndex::build(TeenyMenuPage& root) {
+  _root = &root;
+  _entriesCount = 0;
+  free(_slots);
+  _slots = nullptr;
+  _slotsMask = 0;
+  boolean built = addEntry(TEENYMENU_INDEX_HASH_BASIS, nullptr, 0, 0) && addMenuPage(root, 0);
+  // Hash table at most half full, so that probe sequences stay short
+  uint16_t slotsCount = 4;
+  while (slotsCount < _entriesCount * 2 && slotsCount < TEENYMENU_INDEX_SLOTS_MAX) {
+    slotsCount *= 2;
+  }
+  _slots = (uint16_t*)calloc(slotsCount, sizeof(uint16_t));
+  if (_slots == nullptr) {
+    _entriesCount = 0;
+    return false;
+  }
+  _slotsMask = slotsCount - 1;
+  for (uint16_t i=1; i<_entriesCount; i++) {
+    uint16_t slot = _entries[i].hash & _slotsMask;
+    while (_slots[slot] != 0) {
+      slot = (slot + 1) & _slotsMask;
+    }
+    _slots[slot] = i;
+  }
+  return built;
+}
+
+uint16_t TeenyMenuIndex::getItemsCount() {
+  return (_entriesCount > 0) ? _entriesCount - 1 : 0;
+}
+
+boolean TeenyMenuIndex::addMenuPage(TeenyMenuPage& page, uint16_t parent) {
+  // Don't follow links back to a page already on the path
+  for (uint16_t entryNum=parent; entryNum!=0; ) {
+    entryNum = _entries[entryNum].parent;
+    if (getLinkedPage(entryNum) == &page) {
+      return true;
+    }
+  }
+  uint32_t prefix = (parent == 0) ? TEENYMENU_INDEX_HASH_BASIS : hashPath(_entries[parent].hash, "/", 1);
+  for (byte i=0; i<page.itemsCountTotal; i++) {
+    TeenyMenuItem* menuItemTmp = page.getMenuItem(i, true);
+    if (menuItemTmp->type == TEENYMENU_ITEM_BACK) {
+      continue;
+    }
+    if (_entriesCount == TEENYMENU_INDEX_ENTRIES_MAX ||
+        !addEntry(hashPath(prefix, menuItemTmp->title, strlen(menuItemTmp->title)), menuItemTmp, parent, i)) {
+      return false;
+    }
+    if (menuItemTmp->type == TEENYMENU_ITEM_LINK && menuItemTmp->linkedPage != nullptr &&
+        !addMenuPage(*menuItemTmp->linkedPage, _entriesCount - 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+boolean TeenyMenuIndex::addEntry(uint32_t hash, TeenyMenuItem* item, uint16_t parent, byte indexTotal) {
+  if (_entriesCount == _entriesCapacity) {
+    // Grow geometrically so that adding an entry is amortized O(1)
+    uint16_t capacity = (_entriesCapacity < 16) ? 16 : _entriesCapacity * 2;
+    Entry* entries = (Entry*)realloc(_entries, capacity * sizeof(Entry));
+    if (entries == nullptr) {
+      return false;
+    }
+    _entries = entries;
+    _entriesCapacity = capacity;
+  }
+  _entries[_entriesCount++] = { hash, item, parent, indexTotal };
+  return true;
+}
+
+int TeenyMenuIndex::findEntry(const char* path, uint16_t len) {
+  if (len == 0) {
+    return (_entriesCount > 0) ? 0 : -1;
+  }
+  if (_slots == nullptr) {
+    return -1;
+  }
+  uint32_t hash = hashPath(TEENYMENU_INDEX_HASH_BASIS, path, len);
+  for (uint16_t slot=hash & _slotsMask; _slots[slot]!=0; slot=(slot + 1) & _slotsMask) {
+    uint16_t entryNum = _slots[slot];
+    if (_entries[entryNum].hash == hash && matchPath(entryNum, path, len)) {
+      return entryNum;
+    }
+  }
+  return -1;
+}
+
+int TeenyMenuIndex::findPageEntry(const char* path) {
+  uint16_t len = strlen(path);
+  if (len > 0 && path[len-1] == '/') {
+    len--;
+  }
+  int entryNum = findEntry(path, len);
+  return (entryNum < 0 || getLinkedPage(entryNum) == nullptr) ? -1 : entryNum;
+}
+
+// Compare the titles of the entry and of the link items leading to it with the path, from its end
+boolean TeenyMenuIndex::matchPath(uint16_t entryNum, const char* path, uint16_t len) {
+  uint16_t end = len;
+  while (entryNum != 0) {
+    const char* title = _entries[entryNum].item->title;
+    uint16_t titleLen = strlen(title);
+    if (titleLen > end || memcmp(path + end - titleLen, title, titleLen) != 0) {
+      return false;
+    }
+    end -= titleLen;
+    entryNum = _entries[entryNum].parent;
+    if (entryNum == 0) {
+      break;
+    }
+    if (end == 0 || path[end-1] != '/') {
+      return false;
+    }
+    end--;
+  }
+  return end == 0;
+}
+
+TeenyMenuPage* TeenyMenuIndex::getLinkedPage(uint16_t entryNum) {
+  if (entryNum == 0) {
+    return _root;
+  }
+  TeenyMenuItem* menuItemTmp = _entries[entryNum].item;
+  return (menuItemTmp->type == TEENYMENU_ITEM_LINK) ? menuItemTmp->linkedPage : nullptr;
+}
+
+TeenyMenuItem* TeenyMenuIndex::getMenuItem(const char* path) {
+  int entryNum = findEntry(path, strlen(path));
+  return (entryNum > 0) ? _entries[entryNum].item : nullptr;
+}
+
+TeenyMenuPage* TeenyMenuIndex::getMenuPage(const char* path) {
+  int entryNum = findPageEntry(path);
+  return (entryNum < 0) ? nullptr : getLinkedPage(entryNum);
+}
+
+TeenyMenuItem* TeenyMenuIndex::getValueItem(const char* path) {
+  TeenyMenuItem* menuItemTmp = getMenuItem(path);
+  return (menuItemTmp != nullptr && menuItemTmp->type == TEENYMENU_ITEM_VAL) ? menuItemTmp : nullptr;
+}
+
+boolean TeenyMenuIndex::get(const char* path, int32_t& value) {
+  TeenyMenuItem* menuItemTmp = getValueItem(path);
+  if (menuItemTmp == nullptr) {
+    return false;
+  }
+  void* variable = menuItemTmp->var.linkedVariable;
+  switch (menuItemTmp->linkedType) {
+    case TEENYMENU_VAL_BYTE:
+      value = *(byte*)variable;
+      break;
+    case TEENYMENU_VAL_INTEGER:
+      value = *(int*)variable;
+      break;
+    case TEENYMENU_VAL_INT32T:
+      value = *(int32_t*)variable;
+      break;
+    case TEENYMENU_VAL_BOOLEAN:
+      value = *(boolean*)variable;
+      break;
+    case TEENYMENU_VAL_SELECT:
+      value = menuItemTmp->var.select->getVariableValue(variable);
+      break;
+    case TEENYMENU_VAL_TYPED: {
+      int64_t typedValue = menuItemTmp->var.ops->get(variable);
+      if (!menuItemTmp->var.ops->integer || typedValue != (int32_t)typedValue) {
+        return false;
+      }
+      value = typedValue;
+      break;
+    }
+  }
+  return true;
+}
+
+boolean TeenyMenuIndex::set(const char* path, int32_t value) {
+  TeenyMenuItem* menuItemTmp = getValueItem(path);
+  if (menuItemTmp == nullptr || menuItemTmp->readonly) {
+    return false;
+  }
+  void* variable = menuItemTmp->var.linkedVariable;
+  void* rangeMin = menuItemTmp->getRangeMin();
+  void* rangeMax = menuItemTmp->getRangeMax();
+  switch (menuItemTmp->linkedType) {
+    case TEENYMENU_VAL_BYTE:
+      if (value < 0 || value > 255 || (rangeMin != nullptr && value < *(byte*)rangeMin) ||
+          (rangeMax != nullptr && value > *(byte*)rangeMax)) {
+        return false;
+      }
+      *(byte*)variable = value;
+      break;
+    case TEENYMENU_VAL_INTEGER:
+      if ((int32_t)(int)value != value || (rangeMin != nullptr && value < *(int*)rangeMin) ||
+          (rangeMax != nullptr && value > *(int*)rangeMax)) {
+        return false;
+      }
+      *(int*)variable = value;
+      break;
+    case TEENYMENU_VAL_INT32T:
+      if ((rangeMin != nullptr && value < *(int32_t*)rangeMin) || (rangeMax != nullptr && value > *(int32_t*)rangeMax)) {
+        return false;
+      }
+      *(int32_t*)variable = value;
+      break;
+    case TEENYMENU_VAL_BOOLEAN:
+      *(boolean*)variable = (value != 0);
+      break;
+    case TEENYMENU_VAL_SELECT: {
+      TeenyMenuSelect* select = menuItemTmp->var.select;
+      byte optionNum = 0;
+      while (optionNum < select->getLength() && select->getOptionValue(optionNum) != value) {
+        optionNum++;
+      }
+      if (optionNum == select->getLength()) {
+        return false;
+      }
+      select->setValue(variable, optionNum);
+      break;
+    }
+    case TEENYMENU_VAL_TYPED:
+      // Values out of the range of the item (or of its type, not surviving the round trip) come back changed
+      if (!menuItemTmp->var.ops->integer || menuItemTmp->var.ops->step(menuItemTmp, value, 0) != value) {
+        return false;
+      }
+      menuItemTmp->var.ops->set(variable, value);
+      break;
+  }
+  if (menuItemTmp->var.saveAction != nullptr) {
+    menuItemTmp->var.saveAction();
+  }
+  return true;
+}
+
+uint32_t TeenyMenuIndex::hashPath(uint32_t hash, const char* str, uint16_t len) {
+  while (len--) {
+    hash = (hash ^ (uint8_t)*str++) * TEENYMENU_INDEX_HASH_PRIME;
+  }
+  return hash;
+}
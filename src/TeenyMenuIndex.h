@@ -0,0 +1,63 @@
+#ifndef HEADER_TEENYMENUINDEX
+#define HEADER_TEENYMENUINDEX
+
+#include <Arduino.h>
+#include "TeenyMenuPage.h"
+
+// Declaration of TeenyMenuIndex class: hash index of the items of a page tree by their path, built once by build(),
+// so that items and pages are found in O(1) from their path, e.g. for scripted configuration or deep links
+// (see TeenyMenu::navigateTo())
+// Path of an item: titles of the link items leading to its page, then its title, separated by '/', e.g.
+// "Settings/Radio/Channel". Path of a page: path of a link item to it followed by '/', e.g. "Settings/Radio/",
+// or "" for the root page
+// Pages linked from several places are indexed under each path (except through links back to a page already on the
+// path), items with the same path as an earlier one and Back items are not found. Titles must not contain '/'
+class TeenyMenuIndex {
+  template <class T>
+  friend class TeenyMenu;
+  public:
+    TeenyMenuIndex();
+    ~TeenyMenuIndex();
+    TeenyMenuIndex(const TeenyMenuIndex&) = delete;
+    TeenyMenuIndex& operator=(const TeenyMenuIndex&) = delete;
+    // Index the items of the supplied page and of the pages it links to, replacing the previous index
+    // Build it again after items are added to the pages (hiding and showing items needs no rebuild)
+    // Returns false if memory ran out or the tree has more than 16383 item paths (the items indexed so far are found)
+    boolean build(TeenyMenuPage& root);
+    uint16_t getItemsCount();                      // Count of items indexed
+    TeenyMenuItem* getMenuItem(const char* path);  // Item with supplied path, nullptr if none
+    TeenyMenuPage* getMenuPage(const char* path);  // Page with supplied path (also without the trailing '/'), nullptr if none
+    // Value of the variable linked to the value item with supplied path (the value of the option for a select)
+    // Returns false if the path is not a value item, or its value is not an int32_t integer (see TeenyMenuValue)
+    boolean get(const char* path, int32_t& value);
+    // Assign value to the variable linked to the value item with supplied path, as if saved from the menu (the save
+    // action of the item is called). The value must be within the range of the item (one of the option values for a
+    // select). Call TeenyMenu::refreshValues() of the menus showing the item
+    // Returns false if the path is not a value item, the item is readonly or the value is out of range (or the item
+    // is a TeenyMenuValue of a floating point type)
+    boolean set(const char* path, int32_t value);
+  private:
+    // Entry per item, in the order of the walk through the pages (entry 0 stands for the root page)
+    struct Entry {
+      uint32_t hash;                               // Hash of the path
+      TeenyMenuItem* item;                         // nullptr for the root page
+      uint16_t parent;                             // Entry of the link item to the page of the item
+      byte indexTotal;                             // Index of the item among all items of its page
+    };
+    TeenyMenuPage* _root = nullptr;
+    Entry* _entries = nullptr;
+    uint16_t _entriesCount = 0;
+    uint16_t _entriesCapacity = 0;
+    uint16_t* _slots = nullptr;                    // Open addressing hash table of entry numbers, 0 for empty slots
+    uint16_t _slotsMask = 0;                       // Count of slots - 1 (power of 2)
+    boolean addMenuPage(TeenyMenuPage& page, uint16_t parent);  // Add entries for the items of the page
+    boolean addEntry(uint32_t hash, TeenyMenuItem* item, uint16_t parent, byte indexTotal);
+    int findEntry(const char* path, uint16_t len); // Entry with supplied path, -1 if none
+    int findPageEntry(const char* path);           // Entry of the link item to the page with supplied path (0 for root)
+    boolean matchPath(uint16_t entryNum, const char* path, uint16_t len);
+    TeenyMenuPage* getLinkedPage(uint16_t entryNum);  // Page the entry links to (root page for entry 0)
+    TeenyMenuItem* getValueItem(const char* path); // Value item with supplied path, nullptr if none
+    static uint32_t hashPath(uint32_t hash, const char* str, uint16_t len);
+};
+
+#endif
@@ -2,243 +2,90 @@
 #include "TeenyMenuItem.h"
 #include "TeenyMenuConstants.h"
 
-TeenyMenuItem::TeenyMenuItem(const char* title_, byte& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_SELECT)
-  , select(&select_)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_SELECT)
-  , select(&select_)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int32_t& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_SELECT)
-  , select(&select_)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, byte& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_SELECT)
-  , select(&select_)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_SELECT)
-  , select(&select_)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int32_t& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_SELECT)
-  , select(&select_)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, byte& linkedVariable_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_BYTE)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int& linkedVariable_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_INTEGER)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int32_t& linkedVariable_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_INT32T)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, boolean& linkedVariable_, void (*saveAction_)())
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_BOOLEAN)
-  , saveAction(saveAction_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-//---
+// Range records of the items given range variables rather than a TeenyMenuRange, and of setEditSteps(), shared by
+// the items with the same range and edit steps, so that none is allocated nor left behind by an item going away
+static TeenyMenuRange rangePool[TEENYMENU_RANGE_POOL];
+static byte rangePoolCount = 0;
+
+// Returns nullptr if the pool is full
+static const TeenyMenuRange* poolRange(void* rangeMin, void* rangeMax, const int32_t* editSteps, byte editStepsCount) {
+  for (byte i=0; i<rangePoolCount; i++) {
+    const TeenyMenuRange& range = rangePool[i];
+    if (range.rangeMin == rangeMin && range.rangeMax == rangeMax && range.editSteps == editSteps &&
+        range.editStepsCount == editStepsCount) {
+      return &range;
+    }
+  }
+  if (rangePoolCount == TEENYMENU_RANGE_POOL) {
+    return nullptr;
+  }
+  rangePool[rangePoolCount] = TeenyMenuRange{rangeMin, rangeMax, editSteps, editStepsCount};
+  return &rangePool[rangePoolCount++];
+}
 
 TeenyMenuItem::TeenyMenuItem(const char* title_, byte& linkedVariable_, byte& rangeMin_, byte& rangeMax_, void (*saveAction_)())
   : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_BYTE)
-  , rangeMin(&rangeMin_)
-  , rangeMax(&rangeMax_)
-  , saveAction(saveAction_)
+  , var(&linkedVariable_, poolRange(&rangeMin_, &rangeMax_, nullptr, 0), saveAction_)
   , type(TEENYMENU_ITEM_VAL)
+  , linkedType(TEENYMENU_VAL_BYTE)
+  , readonly(false)
+  , hidden(false)
 { }
 
 TeenyMenuItem::TeenyMenuItem(const char* title_, int& linkedVariable_, int& rangeMin_, int& rangeMax_, void (*saveAction_)())
   : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_INTEGER)
-  , rangeMin(&rangeMin_)
-  , rangeMax(&rangeMax_)
-  , saveAction(saveAction_)
+  , var(&linkedVariable_, poolRange(&rangeMin_, &rangeMax_, nullptr, 0), saveAction_)
   , type(TEENYMENU_ITEM_VAL)
+  , linkedType(TEENYMENU_VAL_INTEGER)
+  , readonly(false)
+  , hidden(false)
 { }
 
+#ifndef TEENYMENU_INT32T_IS_INT
 TeenyMenuItem::TeenyMenuItem(const char* title_, int32_t& linkedVariable_, int32_t& rangeMin_, int32_t& rangeMax_, void (*saveAction_)())
   : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_INT32T)
-  , rangeMin(&rangeMin_)
-  , rangeMax(&rangeMax_)
-  , saveAction(saveAction_)
+  , var(&linkedVariable_, poolRange(&rangeMin_, &rangeMax_, nullptr, 0), saveAction_)
   , type(TEENYMENU_ITEM_VAL)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, byte& linkedVariable_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_BYTE)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int& linkedVariable_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_INTEGER)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, int32_t& linkedVariable_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
   , linkedType(TEENYMENU_VAL_INT32T)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
+  , readonly(false)
+  , hidden(false)
 { }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, boolean& linkedVariable_, boolean readonly_)
-  : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_BOOLEAN)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
-{ }
-
-//---
+#endif
 
 TeenyMenuItem::TeenyMenuItem(const char* title_, byte& linkedVariable_, byte& rangeMin_, byte& rangeMax_, boolean readonly_)
   : title(title_)
-  , linkedVariable(&linkedVariable_)
+  , var(&linkedVariable_, poolRange(&rangeMin_, &rangeMax_, nullptr, 0), nullptr)
+  , type(TEENYMENU_ITEM_VAL)
   , linkedType(TEENYMENU_VAL_BYTE)
-  , rangeMin(&rangeMin_)
-  , rangeMax(&rangeMax_)
   , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
+  , hidden(false)
 { }
 
 TeenyMenuItem::TeenyMenuItem(const char* title_, int& linkedVariable_, int& rangeMin_, int& rangeMax_, boolean readonly_)
   : title(title_)
-  , linkedVariable(&linkedVariable_)
+  , var(&linkedVariable_, poolRange(&rangeMin_, &rangeMax_, nullptr, 0), nullptr)
+  , type(TEENYMENU_ITEM_VAL)
   , linkedType(TEENYMENU_VAL_INTEGER)
-  , rangeMin(&rangeMin_)
-  , rangeMax(&rangeMax_)
   , readonly(readonly_)
-  , type(TEENYMENU_ITEM_VAL)
+  , hidden(false)
 { }
 
+#ifndef TEENYMENU_INT32T_IS_INT
 TeenyMenuItem::TeenyMenuItem(const char* title_, int32_t& linkedVariable_, int32_t& rangeMin_, int32_t& rangeMax_, boolean readonly_)
   : title(title_)
-  , linkedVariable(&linkedVariable_)
-  , linkedType(TEENYMENU_VAL_INT32T)
-  , rangeMin(&rangeMin_)
-  , rangeMax(&rangeMax_)
-  , readonly(readonly_)
+  , var(&linkedVariable_, poolRange(&rangeMin_, &rangeMax_, nullptr, 0), nullptr)
   , type(TEENYMENU_ITEM_VAL)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, TeenyMenuPage& linkedPage_, boolean readonly_)
-  : title(title_)
-  , linkedPage(&linkedPage_)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_LINK)
-{ }
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, TeenyMenuPage* linkedPage_, boolean readonly_)
-  : title(title_)
-  , linkedPage(linkedPage_)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_LINK)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(boolean readonly_)
-  : title("")
-  , linkedPage(nullptr)
-  , readonly(readonly_)
-  , type(TEENYMENU_ITEM_BACK)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(const char* title_, void (*buttonAction_)(), boolean readonly_)
-  : title(title_)
-  , buttonAction(buttonAction_)
+  , linkedType(TEENYMENU_VAL_INT32T)
   , readonly(readonly_)
-  , type(TEENYMENU_ITEM_BUTTON)
-{ }
-
-//---
-
-TeenyMenuItem::TeenyMenuItem(const char* title_)
-  : title(title_)
-  , readonly(true)
-  , type(TEENYMENU_ITEM_LABEL)
+  , hidden(false)
 { }
-
-//---
+#endif
 
 void TeenyMenuItem::setTitle(const char* title_) {
   title = title_;
 }
 
-const char* TeenyMenuItem::getTitle() {
+const char* TeenyMenuItem::getTitle() const {
   return title;
 }
 
@@ -246,7 +93,7 @@ void TeenyMenuItem::setReadonly(boolean mode) {
   readonly = mode;
 }
 
-boolean TeenyMenuItem::getReadonly() {
+boolean TeenyMenuItem::getReadonly() const {
   return readonly;
 }
 
@@ -274,15 +121,63 @@ void TeenyMenuItem::show() {
   }
 }
 
-boolean TeenyMenuItem::isHidden() {
+boolean TeenyMenuItem::isHidden() const {
   return hidden;
 }
 
-TeenyMenuItem* TeenyMenuItem::getMenuItemNext() {
-  TeenyMenuItem* menuItemTmp = menuItemNext;
-  while (menuItemTmp != 0 && menuItemTmp->hidden) {
-    menuItemTmp = menuItemTmp->menuItemNext;
+void TeenyMenuItem::setEditSteps(const int32_t* editSteps_, byte editStepsCount_) {
+  if (type != TEENYMENU_ITEM_VAL || linkedType == TEENYMENU_VAL_SELECT || linkedType == TEENYMENU_VAL_BOOLEAN) {
+    return;
   }
-  return menuItemTmp;
+  if (linkedType == TEENYMENU_VAL_TYPED) {
+    var.ops->setEditSteps(this, editSteps_, editStepsCount_);
+    return;
+  }
+  // Range record may be shared or constant, so the item moves to a pooled record with the same range instead
+  void* rangeMin = getRangeMin();
+  void* rangeMax = getRangeMax();
+  if (rangeMin == nullptr && rangeMax == nullptr && (editSteps_ == nullptr || editStepsCount_ == 0)) {
+    var.range = nullptr;
+    return;
+  }
+  const TeenyMenuRange* range = poolRange(rangeMin, rangeMax, editSteps_, editStepsCount_);
+  if (range != nullptr) {
+    var.range = range;
+  }
+}
+
+const TeenyMenuRange* TeenyMenuItem::getRange() const {
+  if (type != TEENYMENU_ITEM_VAL || linkedType == TEENYMENU_VAL_SELECT || linkedType == TEENYMENU_VAL_TYPED) {
+    return nullptr;
+  }
+  return var.range;
+}
+
+void* TeenyMenuItem::getRangeMin() const {
+  const TeenyMenuRange* range = getRange();
+  return (range != nullptr) ? range->rangeMin : nullptr;
 }
 
+void* TeenyMenuItem::getRangeMax() const {
+  const TeenyMenuRange* range = getRange();
+  return (range != nullptr) ? range->rangeMax : nullptr;
+}
+
+const int32_t* TeenyMenuItem::getEditSteps() const {
+  if (type == TEENYMENU_ITEM_VAL && linkedType == TEENYMENU_VAL_TYPED) {
+    byte editStepsCount;
+    return var.ops->getEditSteps(this, editStepsCount);
+  }
+  const TeenyMenuRange* range = getRange();
+  return (range != nullptr) ? range->editSteps : nullptr;
+}
+
+byte TeenyMenuItem::getEditStepsCount() const {
+  if (type == TEENYMENU_ITEM_VAL && linkedType == TEENYMENU_VAL_TYPED) {
+    byte editStepsCount;
+    var.ops->getEditSteps(this, editStepsCount);
+    return editStepsCount;
+  }
+  const TeenyMenuRange* range = getRange();
+  return (range != nullptr) ? range->editStepsCount : 0;
+}
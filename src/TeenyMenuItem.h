@@ -17,15 +17,56 @@
 // Macro constant (alias) for hidden state of the menu item
 #define TEENYMENU_HIDDEN true
 
+// Most range records kept for the menu items constructed with range variables and the ones given edit steps
+// (see TeenyMenuItem::setEditSteps()), altogether; items with the same range variables and edit steps share one
+#ifndef TEENYMENU_RANGE_POOL
+#define TEENYMENU_RANGE_POOL 16
+#endif
+
 // Forward declaration of necessary classes
 class TeenyMenuPage;
 class TeenyMenuSelect;
+class TeenyMenuItem;
+
+// Declaration of TeenyMenuRange type: optional side record of variable menu items, so that the ones
+// without range don't pay for it. Range values are pointers to variables of the same type as the linked variable
+struct TeenyMenuRange {
+  void* rangeMin;                   // Pointer to range minimum value, or nullptr
+  void* rangeMax;                   // Pointer to range maximum value, or nullptr
+  const int32_t* editSteps;         // Edit steps (see TeenyMenuItem::setEditSteps()), or nullptr
+  byte editStepsCount;
+};
+
+// Declaration of TeenyMenuValueOps type: operations on the linked variable of TEENYMENU_VAL_TYPED menu items, one
+// constant table per variable type, instantiated by TeenyMenuValue<V> (see TeenyMenuValue.h), so that the menu
+// handles variables of any type without switching on it. Values are passed as int64_t: integer values as they are,
+// floating point values by their bytes
+struct TeenyMenuValueOps {
+  int64_t (*get)(const void* linkedVariable);
+  void (*set)(void* linkedVariable, int64_t value);
+  // Value moved 'steps' steps of the item up (steps > 0) or down (< 0) within the range of the item, a value out of
+  // the range is brought back within it instead (steps 0 only does that)
+  int64_t (*step)(const TeenyMenuItem* item, int64_t value, int32_t steps);
+  // Edit steps of the item (see TeenyMenuItem::setEditSteps()), kept by the item itself
+  const int32_t* (*getEditSteps)(const TeenyMenuItem* item, byte& editStepsCount);
+  void (*setEditSteps)(TeenyMenuItem* item, const int32_t* editSteps, byte editStepsCount);
+  void (*format)(int64_t value, char* buf, int len);  // As the fmt_*() formatters of TeenyPrtFmt do
+  byte size;                        // Size of the variable
+  boolean integer;                  // Values are integers
+};
 
 // Declaration of TeenyMenuItem class
+// Constructors are constexpr, so menu items that never change can be declared 'TEENYMENU_CONST constexpr TeenyMenuItem'
+// and kept in flash, together with their page's item array (see TeenyMenuPage constructor for constant pages)
 class TeenyMenuItem {
   template <class T>
   friend class TeenyMenu;
   friend class TeenyMenuPage;
+  friend class TeenyMenuIndex;
+  template <class S>
+  friend class TeenyMenuStore;
+  template <class V>
+  friend class TeenyMenuValue;
   public:
     /* 
       Constructors for menu item that represents option select, w/ callback
@@ -34,9 +75,34 @@ class TeenyMenuItem {
       @param 'select_' - reference to TeenyMenuSelect option select
       @param 'saveAction_' - pointer to callback function executed when associated variable is successfully saved
     */
-    TeenyMenuItem(const char* title_, byte& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)());
-    TeenyMenuItem(const char* title_, int& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)());
-    TeenyMenuItem(const char* title_, int32_t& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)());
+    constexpr TeenyMenuItem(const char* title_, byte& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, &select_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_SELECT)
+      , readonly(false)
+      , hidden(false)
+    { }
+
+    constexpr TeenyMenuItem(const char* title_, int& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, &select_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_SELECT)
+      , readonly(false)
+      , hidden(false)
+    { }
+
+#ifndef TEENYMENU_INT32T_IS_INT
+    constexpr TeenyMenuItem(const char* title_, int32_t& linkedVariable_, TeenyMenuSelect& select_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, &select_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_SELECT)
+      , readonly(false)
+      , hidden(false)
+    { }
+#endif
     /* 
       Constructors for menu item that represents option select, w/o callback
       @param 'title_' - title of the menu item displayed on the screen
@@ -46,19 +112,76 @@ class TeenyMenuItem {
       values TEENYMENU_READONLY (alias for true)
       default false
     */
-    TeenyMenuItem(const char* title_, byte& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_ = false);
-    TeenyMenuItem(const char* title_, int& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_ = false);
-    TeenyMenuItem(const char* title_, int32_t& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_ = false);
+    constexpr TeenyMenuItem(const char* title_, byte& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, &select_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_SELECT)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+
+    constexpr TeenyMenuItem(const char* title_, int& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, &select_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_SELECT)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+
+#ifndef TEENYMENU_INT32T_IS_INT
+    constexpr TeenyMenuItem(const char* title_, int32_t& linkedVariable_, TeenyMenuSelect& select_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, &select_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_SELECT)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+#endif
     /* 
       Constructors for menu item that represents variable, w/ callback
       @param 'title_' - title of the menu item displayed on the screen
       @param 'linkedVariable_' - reference to variable that menu item is associated with (either byte, int, char*, boolean)
       @param 'saveAction_' - pointer to callback function executed when associated variable is successfully saved
     */
-    TeenyMenuItem(const char* title_, byte& linkedVariable_, void (*saveAction_)());
-    TeenyMenuItem(const char* title_, int& linkedVariable_, void (*saveAction_)());
-    TeenyMenuItem(const char* title_, int32_t& linkedVariable_, void (*saveAction_)());
-    TeenyMenuItem(const char* title_, boolean& linkedVariable_, void (*saveAction_)());
+    constexpr TeenyMenuItem(const char* title_, byte& linkedVariable_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_BYTE)
+      , readonly(false)
+      , hidden(false)
+    { }
+
+    constexpr TeenyMenuItem(const char* title_, int& linkedVariable_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_INTEGER)
+      , readonly(false)
+      , hidden(false)
+    { }
+
+#ifndef TEENYMENU_INT32T_IS_INT
+    constexpr TeenyMenuItem(const char* title_, int32_t& linkedVariable_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_INT32T)
+      , readonly(false)
+      , hidden(false)
+    { }
+#endif
+    constexpr TeenyMenuItem(const char* title_, boolean& linkedVariable_, void (*saveAction_)())
+      : title(title_)
+      , var(&linkedVariable_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_BOOLEAN)
+      , readonly(false)
+      , hidden(false)
+    { }
     /* 
       Constructors for menu item that represents variable, w/ callback, w/ min/max range
       @param 'title_' - title of the menu item displayed on the screen
@@ -66,10 +189,14 @@ class TeenyMenuItem {
       @param 'rangeMin_' - range minimum value
       @param 'rangeMax_' - range maximum value
       @param 'saveAction_' - pointer to callback function executed when associated variable is successfully saved
+      Range side record is taken from the pool of range records (see TEENYMENU_RANGE_POOL, the item has no range if
+      the pool is full), so these constructors are not constexpr (see constructors taking TeenyMenuRange for constant items)
     */
     TeenyMenuItem(const char* title_, byte& linkedVariable_, byte& rangeMin_, byte& rangeMax_, void (*saveAction_)());
     TeenyMenuItem(const char* title_, int& linkedVariable_, int& rangeMin_, int& rangeMax_, void (*saveAction_)());
+#ifndef TEENYMENU_INT32T_IS_INT
     TeenyMenuItem(const char* title_, int32_t& linkedVariable_, int32_t& rangeMin_, int32_t& rangeMax_, void (*saveAction_)());
+#endif
     /* 
       Constructors for menu item that represents variable, w/o callback
       @param 'title_' - title of the menu item displayed on the screen
@@ -78,10 +205,42 @@ class TeenyMenuItem {
       values TEENYMENU_READONLY (alias for true)
       default false
     */
-    TeenyMenuItem(const char* title_, byte& linkedVariable_, boolean readonly_ = false);
-    TeenyMenuItem(const char* title_, int& linkedVariable_, boolean readonly_ = false);
-    TeenyMenuItem(const char* title_, int32_t& linkedVariable_, boolean readonly_ = false);
-    TeenyMenuItem(const char* title_, boolean& linkedVariable_, boolean readonly_ = false);
+    constexpr TeenyMenuItem(const char* title_, byte& linkedVariable_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_BYTE)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+
+    constexpr TeenyMenuItem(const char* title_, int& linkedVariable_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_INTEGER)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+
+#ifndef TEENYMENU_INT32T_IS_INT
+    constexpr TeenyMenuItem(const char* title_, int32_t& linkedVariable_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_INT32T)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+#endif
+    constexpr TeenyMenuItem(const char* title_, boolean& linkedVariable_, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, nullptr)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_BOOLEAN)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
     /* 
       Constructors for menu item that represents variable, w/o callback, w/ min/max range
       @param 'title_' - title of the menu item displayed on the screen
@@ -91,10 +250,52 @@ class TeenyMenuItem {
       @param 'readonly_' (optional) - set readonly mode for variable that menu item is associated with
       values TEENYMENU_READONLY (alias for true)
       default false
+      Range side record is taken from the pool of range records, as above
     */
     TeenyMenuItem(const char* title_, byte& linkedVariable_, byte& rangeMin_, byte& rangeMax_, boolean readonly_ = false);
     TeenyMenuItem(const char* title_, int& linkedVariable_, int& rangeMin_, int& rangeMax_, boolean readonly_ = false);
+#ifndef TEENYMENU_INT32T_IS_INT
     TeenyMenuItem(const char* title_, int32_t& linkedVariable_, int32_t& rangeMin_, int32_t& rangeMax_, boolean readonly_ = false);
+#endif
+    /* 
+      Constructors for menu item that represents variable, w/ min/max range and edit steps held in a TeenyMenuRange record
+      (the record may be shared between items and declared 'TEENYMENU_CONST constexpr' together with the item)
+      @param 'title_' - title of the menu item displayed on the screen
+      @param 'linkedVariable_' - reference to variable that menu item is associated with (either byte, int, int32_t)
+      @param 'range_' - reference to TeenyMenuRange record, its range values must be of the same type as linkedVariable_
+      @param 'saveAction_' (optional) - pointer to callback function executed when associated variable is successfully saved
+      @param 'readonly_' (optional) - set readonly mode for variable that menu item is associated with
+      values TEENYMENU_READONLY (alias for true)
+      default false
+    */
+    constexpr TeenyMenuItem(const char* title_, byte& linkedVariable_, const TeenyMenuRange& range_, void (*saveAction_)() = nullptr, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, &range_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_BYTE)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+
+    constexpr TeenyMenuItem(const char* title_, int& linkedVariable_, const TeenyMenuRange& range_, void (*saveAction_)() = nullptr, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, &range_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_INTEGER)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+
+#ifndef TEENYMENU_INT32T_IS_INT
+    constexpr TeenyMenuItem(const char* title_, int32_t& linkedVariable_, const TeenyMenuRange& range_, void (*saveAction_)() = nullptr, boolean readonly_ = false)
+      : title(title_)
+      , var(&linkedVariable_, &range_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_INT32T)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
+#endif
     /* 
       Constructor for menu item that represents link to another menu page (via reference)
       @param 'title_' - title of the menu item displayed on the screen
@@ -102,7 +303,14 @@ class TeenyMenuItem {
       @param 'readonly_' (optional) - set readonly mode for the link (user won't be able to navigate to linked page)
       values TEENYMENU_READONLY (alias for true)
     */
-    TeenyMenuItem(const char* title_, TeenyMenuPage& linkedPage_, boolean readonly_ = false);
+    constexpr TeenyMenuItem(const char* title_, TeenyMenuPage& linkedPage_, boolean readonly_ = false)
+      : title(title_)
+      , linkedPage(&linkedPage_)
+      , type(TEENYMENU_ITEM_LINK)
+      , linkedType(0)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
     /* 
       Constructor for menu item that represents link to another menu page (via pointer)
       @param 'title_' - title of the menu item displayed on the screen
@@ -110,13 +318,27 @@ class TeenyMenuItem {
       @param 'readonly_' (optional) - set readonly mode for the link (user won't be able to navigate to linked page)
       values TEENYMENU_READONLY (alias for true)
     */
-    TeenyMenuItem(const char* title_, TeenyMenuPage* linkedPage_, boolean readonly_ = false);
+    constexpr TeenyMenuItem(const char* title_, TeenyMenuPage* linkedPage_, boolean readonly_ = false)
+      : title(title_)
+      , linkedPage(linkedPage_)
+      , type(TEENYMENU_ITEM_LINK)
+      , linkedType(0)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
     /* 
       Constructor for menu item that represents returning to the previous/parent menu page
       @param 'readonly_' (optional) - set readonly mode for the link (user won't be able to navigate to previous/parent page)
       values TEENYMENU_READONLY (alias for true)
     */
-    TeenyMenuItem(boolean readonly_ = false);
+    constexpr TeenyMenuItem(boolean readonly_ = false)
+      : title("")
+      , linkedPage(nullptr)
+      , type(TEENYMENU_ITEM_BACK)
+      , linkedType(0)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
     /* 
       Constructor for menu item that represents button
       @param 'title_' - title of the menu item displayed on the screen
@@ -124,40 +346,94 @@ class TeenyMenuItem {
       @param 'readonly_' (optional) - set readonly mode for the button (user won't be able to call action associated with it)
       values TEENYMENU_READONLY (alias for true)
     */
-    TeenyMenuItem(const char* title_, void (*buttonAction_)(), boolean readonly_ = false);
+    constexpr TeenyMenuItem(const char* title_, void (*buttonAction_)(), boolean readonly_ = false)
+      : title(title_)
+      , buttonAction(buttonAction_)
+      , type(TEENYMENU_ITEM_BUTTON)
+      , linkedType(0)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
     /* 
       Constructor for menu item that represents a non-functional (readonly) text item
       @param 'title_' - title of the menu item displayed on the screen
     */
-    TeenyMenuItem(const char* title_);
+    constexpr TeenyMenuItem(const char* title_)
+      : title(title_)
+      , linkedPage(nullptr)
+      , type(TEENYMENU_ITEM_LABEL)
+      , linkedType(0)
+      , readonly(true)
+      , hidden(false)
+    { }
 
     void setTitle(const char* title_);            // Set title of the menu item
-    const char* getTitle();                       // Get title of the menu item
+    const char* getTitle() const;                 // Get title of the menu item
     void setReadonly(boolean mode = true);  // Explicitly set or unset readonly mode for variable that menu item is associated with
                                             // (relevant for TEENYMENU_VAL_INTEGER, TEENYMENU_VAL_BYTE, TEENYMENU_VAL_BOOLEAN
                                             // variable menu items and TEENYMENU_VAL_SELECT option select), or menu button TEENYMENU_ITEM_BUTTON
                                             // and menu link TEENYMENU_ITEM_LINK/BACK, pressing of which won't result in any action, associated with them
-    boolean getReadonly();                  // Get readonly state of the variable that menu item is associated with (as well as menu link or button)
+    boolean getReadonly() const;            // Get readonly state of the variable that menu item is associated with (as well as menu link or button)
     void hide(boolean hide = true);         // Explicitly hide or show menu item
     void show();                            // Explicitly show menu item
-    boolean isHidden();                     // Get hidden state of the menu item
+    boolean isHidden() const;               // Get hidden state of the menu item
+    void setEditSteps(const int32_t* editSteps_, byte editStepsCount_);  // Accelerate editing of the variable: holding or quickly repeating
+                                            // TEENYMENU_KEY_UP/DOWN moves through the supplied (increasing) step sizes, e.g. {1, 10, 100, 1000}
+                                            // (relevant for TEENYMENU_VAL_INTEGER, TEENYMENU_VAL_INT32T and TEENYMENU_VAL_BYTE variable menu items,
+                                            // and TeenyMenuValue items, for which step sizes count steps of the item)
+                                            // Other items than TeenyMenuValue ones take a record from the pool of range records
+                                            // (see TEENYMENU_RANGE_POOL), the call is ignored if the pool is full
+  protected:
+    // Constructor for TEENYMENU_VAL_TYPED menu items, used by TeenyMenuValue<V>
+    constexpr TeenyMenuItem(const char* title_, void* linkedVariable_, const TeenyMenuValueOps& ops_, void (*saveAction_)(), boolean readonly_)
+      : title(title_)
+      , var(linkedVariable_, &ops_, saveAction_)
+      , type(TEENYMENU_ITEM_VAL)
+      , linkedType(TEENYMENU_VAL_TYPED)
+      , readonly(readonly_)
+      , hidden(false)
+    { }
   private:
+    // Payload of TEENYMENU_ITEM_VAL menu items
+    struct LinkedVar {
+      void* linkedVariable;
+      union {
+        TeenyMenuSelect* select;                  // TEENYMENU_VAL_SELECT
+        const TeenyMenuRange* range;              // other value types, nullptr if there is no range nor edit steps
+        const TeenyMenuValueOps* ops;             // TEENYMENU_VAL_TYPED
+      };
+      void (*saveAction)();
+      constexpr LinkedVar(void* linkedVariable_, TeenyMenuSelect* select_, void (*saveAction_)())
+        : linkedVariable(linkedVariable_), select(select_), saveAction(saveAction_) { }
+      constexpr LinkedVar(void* linkedVariable_, const TeenyMenuRange* range_, void (*saveAction_)())
+        : linkedVariable(linkedVariable_), range(range_), saveAction(saveAction_) { }
+      constexpr LinkedVar(void* linkedVariable_, const TeenyMenuValueOps* ops_, void (*saveAction_)())
+        : linkedVariable(linkedVariable_), ops(ops_), saveAction(saveAction_) { }
+      constexpr LinkedVar(void* linkedVariable_, void (*saveAction_)())
+        : linkedVariable(linkedVariable_), range(nullptr), saveAction(saveAction_) { }
+    };
+    const TeenyMenuRange* getRange() const;       // Range side record of TEENYMENU_ITEM_VAL menu item, nullptr if there is none
+    void* getRangeMin() const;                    // Range values and edit steps of TEENYMENU_ITEM_VAL menu item, or nullptr/0 if not set
+    void* getRangeMax() const;
+    const int32_t* getEditSteps() const;
+    byte getEditStepsCount() const;
     const char* title;
-    byte type;
-    void* linkedVariable;
-    byte linkedType;
-    void* rangeMin;
-    void* rangeMax;
-    boolean readonly = false;
-    boolean hidden = false;
-    TeenyMenuSelect* select;
+    union {                                       // Only the member matching type is valid
+      LinkedVar var;                              // TEENYMENU_ITEM_VAL
+      TeenyMenuPage* linkedPage;                  // TEENYMENU_ITEM_LINK
+      void (*buttonAction)();                     // TEENYMENU_ITEM_BUTTON
+    };
     TeenyMenuPage* parentPage = nullptr;
-    TeenyMenuPage* linkedPage;
-    TeenyMenuItem* menuItemNext;
-    TeenyMenuItem* getMenuItemNext();             // Get next menu item, excluding hidden ones
-    void (*buttonAction)();
-    void (*saveAction)();
+    byte indexTotal = 0;                          // Index of the menu item within parentPage, including hidden ones
+    byte type : 3;
+    byte linkedType : 3;
+    boolean readonly : 1;
+    boolean hidden : 1;
 };
 
+// Keep the menu item at six pointers at most (24 bytes on 32-bit boards); anything that
+// is not needed by every menu item belongs in the payload union or the range side record
+static_assert(sizeof(TeenyMenuItem) <= 6 * sizeof(void*), "TeenyMenuItem should not grow beyond six pointers");
+
 #endif
 
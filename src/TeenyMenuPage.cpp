@@ -9,6 +9,33 @@ TeenyMenuPage::TeenyMenuPage(const char* title_, void (*enterAction_)(), void (*
   keyDownAction(keyDownAction_)
 { }
 
+TeenyMenuPage::TeenyMenuPage(const char* title_, const TeenyMenuItem* const* menuItems_, byte count_,
+                             void (*enterAction_)(), void (*exitAction_)(), void (*keyUpAction_)(), void (*keyDownAction_)()) :
+  title(title_),
+  enterAction(enterAction_),
+  exitAction(exitAction_),
+  keyUpAction(keyUpAction_),
+  keyDownAction(keyDownAction_)
+{
+  // Items of a constant page are only ever read, so dropping const here is safe
+  _menuItems = const_cast<TeenyMenuItem**>(menuItems_);
+  _menuItemsConst = true;
+  itemsCount = count_;
+  itemsCountTotal = count_;
+}
+
+TeenyMenuPage::TeenyMenuPage(const char* title_, const TeenyMenuRows& rows_, void (*enterAction_)(), void (*exitAction_)()) :
+  title(title_),
+  enterAction(enterAction_),
+  exitAction(exitAction_),
+  keyUpAction(nullptr),
+  keyDownAction(nullptr)
+{
+  // An empty constant item array, so that no menu item can be added
+  _menuItemsConst = true;
+  _rows = &rows_;
+}
+
 void TeenyMenuPage::setParentMenuPage(TeenyMenuPage& parentMenuPage) {
   _parentMenuPage = &parentMenuPage;
 }
@@ -26,97 +53,264 @@ const char* TeenyMenuPage::getTitle() {
 }
 
 void TeenyMenuPage::addMenuItem(TeenyMenuItem& menuItem) {
+  if (reserveMenuItems(itemsCountTotal+1) && appendMenuItem(menuItem)) {
+    if (_visibleTree != nullptr) {
+      // New Fenwick node covers the range (n - lowbit(n), n] of 1-based indexes
+      byte n = itemsCountTotal;
+      _visibleTree[n-1] = (menuItem.hidden ? 0 : 1) + visibleTreeRank(n-1) - visibleTreeRank(n - (n & -n));
+    } else if (menuItem.hidden && !buildVisibleTree()) {
+      // Without the visibility index every item has to be visible
+      menuItem.hidden = false;
+      itemsCount++;
+    }
+  }
+}
+
+void TeenyMenuPage::addMenuItems(TeenyMenuItem* const* menuItems, byte count) {
+  if (!reserveMenuItems(min(itemsCountTotal + count, 255))) {
+    return;
+  }
+  byte indexFirst = itemsCountTotal;
+  boolean hidden = false;
+  for (byte i=0; i<count; i++) {
+    if (appendMenuItem(*menuItems[i]) && menuItems[i]->hidden) {
+      hidden = true;
+    }
+  }
+  if ((_visibleTree != nullptr || hidden) && !buildVisibleTree()) {
+    for (byte i=indexFirst; i<itemsCountTotal; i++) {
+      if (_menuItems[i]->hidden) {
+        _menuItems[i]->hidden = false;
+        itemsCount++;
+      }
+    }
+  }
+}
+
+boolean TeenyMenuPage::reserveMenuItems(byte count) {
+  if (count <= _menuItemsCapacity) {
+    return true;
+  }
+  if (_menuItemsConst) {
+    return false;
+  }
+  // Grow the index arrays geometrically so that adding an item is amortized O(1)
+  byte capacity = (_menuItemsCapacity < 8) ? 8 : ((_menuItemsCapacity < 128) ? _menuItemsCapacity * 2 : 255);
+  if (capacity < count) {
+    capacity = count;
+  }
+  TeenyMenuItem** menuItems = (TeenyMenuItem**)realloc(_menuItems, capacity * sizeof(TeenyMenuItem*));
+  if (menuItems == nullptr) {
+    return false;
+  }
+  _menuItems = menuItems;
+  if (_visibleTree != nullptr) {
+    byte* visibleTree = (byte*)realloc(_visibleTree, capacity * sizeof(byte));
+    if (visibleTree == nullptr) {
+      return false;
+    }
+    _visibleTree = visibleTree;
+  }
+  _menuItemsCapacity = capacity;
+  return true;
+}
+
+boolean TeenyMenuPage::appendMenuItem(TeenyMenuItem& menuItem) {
   // Prevent adding menu item that was already added to another (or the same) page
-  if (menuItem.parentPage == nullptr) {
-    if (itemsCountTotal == 0) {
-      // If menu page is empty, link supplied menu item from within page directly (this will be the first menu item in a page)
-      _menuItem = &menuItem;
-    } else {
-      // If menu page is not empty, link supplied menu item from within the last menu item of the page
-      getMenuItem(itemsCountTotal-1, true)->menuItemNext = &menuItem;
+  if (menuItem.parentPage != nullptr || itemsCountTotal == 255 || itemsCountTotal == _menuItemsCapacity) {
+    return false;
+  }
+  menuItem.parentPage = this;
+  menuItem.indexTotal = itemsCountTotal;
+  _menuItems[itemsCountTotal] = &menuItem;
+  if (!menuItem.hidden) {
+    itemsCount++;
+  }
+  itemsCountTotal++;
+  return true;
+}
+
+boolean TeenyMenuPage::buildVisibleTree() {
+  if (_visibleTree == nullptr) {
+    _visibleTree = (byte*)malloc(_menuItemsConst ? itemsCountTotal : _menuItemsCapacity);
+    if (_visibleTree == nullptr) {
+      return false;
     }
-    menuItem.parentPage = this;
-    if (!menuItem.hidden) {
-      itemsCount++;
+  }
+  // Items of a constant page are all visible when the tree is first built
+  for (byte i=0; i<itemsCountTotal; i++) {
+    _visibleTree[i] = (!_menuItemsConst && _menuItems[i]->hidden) ? 0 : 1;
+  }
+  // Fill the Fenwick tree in O(n) by pushing each node into its parent
+  for (int i=1; i<=itemsCountTotal; i++) {
+    int parent = i + (i & -i);
+    if (parent <= itemsCountTotal) {
+      _visibleTree[parent-1] += _visibleTree[i-1];
     }
-    itemsCountTotal++;
-    resetCurrentItemNum();
   }
+  return true;
 }
 
-byte TeenyMenuPage::getCurrentItemNum() {
-  return currentItemNum;
+teenyMenu_row_t TeenyMenuPage::getRowsCount() {
+  return (_rows != nullptr) ? _rows->count() : itemsCount;
 }
 
-void TeenyMenuPage::resetCurrentItemNum() {
-  currentItemNum = 0;
+boolean TeenyMenuPage::isVirtual() {
+  return _rows != nullptr;
+}
+
+teenyMenu_row_t TeenyMenuPage::getCursorItemNum(teenyMenu_row_t cursor) {
+  if (_rows != nullptr) {
+    // Rows of a virtual page may have been removed since the cursor was set
+    teenyMenu_row_t rowsCount = _rows->count();
+    return (cursor < rowsCount) ? cursor : ((rowsCount > 0) ? rowsCount-1 : 0);
+  }
+  if (itemsCount == 0) {
+    return 0;
+  }
+  if (cursor >= itemsCountTotal) {
+    return itemsCount-1;
+  }
+  teenyMenu_row_t itemNum = visibleTreeRank(cursor);
+  // A hidden item passes the focus to the visible item before it
+  if (itemNum > 0 && !isMenuItemVisible(cursor)) {
+    itemNum--;
+  }
+  return min(itemNum, (teenyMenu_row_t)(itemsCount-1));
+}
+
+teenyMenu_row_t TeenyMenuPage::getItemCursor(teenyMenu_row_t itemNum) {
+  if (_rows != nullptr || itemNum >= itemsCount) {
+    return itemNum;
+  }
+  return visibleTreeSelect(itemNum);
+}
+
+teenyMenu_row_t TeenyMenuPage::getDefaultItemNum() {
+  teenyMenu_row_t currentItemNum = 0;
   if(itemsCount>0) {
     currentItemNum = itemsCount-1;
     if(itemsCount>1) {
+      TeenyMenuItem* currentItem = getMenuItem(currentItemNum);
       for (byte i=itemsCount-1; i>0; i--) {
-        if ((getMenuItem(i-1)->type!=TEENYMENU_ITEM_BACK && !getMenuItem(i-1)->readonly) ||
-            (getMenuItem(currentItemNum)->readonly)) {
+        TeenyMenuItem* menuItemTmp = getMenuItem(i-1);
+        if ((menuItemTmp->type!=TEENYMENU_ITEM_BACK && !menuItemTmp->readonly) ||
+            (currentItem->readonly)) {
           currentItemNum = i-1;
+          currentItem = menuItemTmp;
         }
       }
     }
   }
+  return currentItemNum;
 }
 
 TeenyMenuItem* TeenyMenuPage::getMenuItem(byte index, boolean total) {
-  TeenyMenuItem* menuItemTmp = (_menuItem->hidden) ? _menuItem->getMenuItemNext() : _menuItem;
-  for (byte i=0; i<index; i++) {
-    menuItemTmp = (total) ? menuItemTmp->menuItemNext : menuItemTmp->getMenuItemNext();
+  if (total) {
+    return (index < itemsCountTotal) ? _menuItems[index] : nullptr;
   }
-  return menuItemTmp;
+  return (index < itemsCount) ? _menuItems[visibleTreeSelect(index)] : nullptr;
 }
 
-TeenyMenuItem* TeenyMenuPage::getCurrentMenuItem() {
-  return getMenuItem(currentItemNum);
+int TeenyMenuPage::getMenuItemNum(const TeenyMenuItem& menuItem) {
+  int indexTotal = getMenuItemIndexTotal(menuItem);
+  if (indexTotal < 0 || !isMenuItemVisible(indexTotal)) {
+    return -1;
+  }
+  return visibleTreeRank(indexTotal);
 }
 
-int TeenyMenuPage::getMenuItemNum(TeenyMenuItem& menuItem) {
-  TeenyMenuItem* menuItemTmp = (_menuItem->hidden) ? _menuItem->getMenuItemNext() : _menuItem;
-  for (byte i=0; i<itemsCount; i++) {
-    if (menuItemTmp == &menuItem) {
-      return i;
+int TeenyMenuPage::getMenuItemIndexTotal(const TeenyMenuItem& menuItem) {
+  if (menuItem.parentPage == this) {
+    return menuItem.indexTotal;
+  }
+  // Items of a constant page don't know their page
+  if (_menuItemsConst) {
+    for (byte i=0; i<itemsCountTotal; i++) {
+      if (_menuItems[i] == &menuItem) {
+        return i;
+      }
     }
-    menuItemTmp = menuItemTmp->getMenuItemNext();
   }
   return -1;
 }
 
+boolean TeenyMenuPage::isMenuItemVisible(byte indexTotal) {
+  if (_visibleTree == nullptr) {
+    return true;
+  }
+  return visibleTreeRank(indexTotal+1) > visibleTreeRank(indexTotal);
+}
+
+void TeenyMenuPage::hideMenuItem(byte index, boolean hide) {
+  setMenuItemVisible(index, !hide);
+}
+
+boolean TeenyMenuPage::isMenuItemHidden(byte index) {
+  return index < itemsCountTotal && !isMenuItemVisible(index);
+}
+
 void TeenyMenuPage::hideMenuItem(TeenyMenuItem& menuItem) {
-  int menuItemNum = getMenuItemNum(menuItem);
-  menuItem.hidden = true;
-  itemsCount--;
-  if (menuItemNum <= currentItemNum) {
-    if (currentItemNum > 0) {
-      currentItemNum--;
-    }
+  setMenuItemVisible(menuItem.indexTotal, false);
+}
+
+void TeenyMenuPage::showMenuItem(TeenyMenuItem& menuItem) {
+  setMenuItemVisible(menuItem.indexTotal, true);
+}
+
+void TeenyMenuPage::setMenuItemVisible(byte indexTotal, boolean visible) {
+  if (indexTotal >= itemsCountTotal || isMenuItemVisible(indexTotal) == visible) {
+    return;
+  }
+  if (_visibleTree == nullptr && !buildVisibleTree()) {
+    return;
+  }
+  if (!_menuItemsConst) {
+    _menuItems[indexTotal]->hidden = !visible;
   }
-  // if (_menuItemBack.linkedPage != nullptr && itemsCount == 1) {
-  //   currentItemNum = 0;
-  // }
-  if (getMenuItem(0)->type==TEENYMENU_ITEM_BACK && itemsCount==1) {
-    currentItemNum = 0;
+  // Cursors of the menus browsing the page point to items among all items, so they don't need to be adjusted
+  if (!visible) {
+    visibleTreeAdd(indexTotal, -1);
+    itemsCount--;
+  } else {
+    visibleTreeAdd(indexTotal, 1);
+    itemsCount++;
   }
 }
 
-void TeenyMenuPage::showMenuItem(TeenyMenuItem& menuItem) {
-  menuItem.hidden = false;
-  itemsCount++;
-  int menuItemNum = getMenuItemNum(menuItem);
-  if (menuItemNum < currentItemNum) {
-    if (currentItemNum < itemsCount-1) {
-      currentItemNum++;
-    }
+void TeenyMenuPage::visibleTreeAdd(byte indexTotal, int delta) {
+  for (int i=indexTotal+1; i<=itemsCountTotal; i+=(i & -i)) {
+    _visibleTree[i-1] += delta;
+  }
+}
+
+byte TeenyMenuPage::visibleTreeRank(byte indexTotal) {
+  if (_visibleTree == nullptr) {
+    return indexTotal;
   }
-  // if (_menuItemBack.linkedPage != nullptr && itemsCount > 1) {
-  //   currentItemNum = 1;
-  // }
-  if (getMenuItem(0)->type==TEENYMENU_ITEM_BACK && itemsCount>1) {
-    currentItemNum = 1;
+  byte rank = 0;
+  for (int i=indexTotal; i>0; i-=(i & -i)) {
+    rank += _visibleTree[i-1];
   }
+  return rank;
 }
 
+int TeenyMenuPage::visibleTreeSelect(byte index) {
+  if (_visibleTree == nullptr) {
+    return index;
+  }
+  // Descend the Fenwick tree to find the position where the count of visible items reaches index+1
+  int pos = 0;
+  int remaining = index + 1;
+  int step = 1;
+  while (step * 2 <= itemsCountTotal) {
+    step *= 2;
+  }
+  for (; step>0; step/=2) {
+    if (pos+step <= itemsCountTotal && _visibleTree[pos+step-1] < remaining) {
+      pos += step;
+      remaining -= _visibleTree[pos-1];
+    }
+  }
+  return pos;
+}
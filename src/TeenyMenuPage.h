@@ -4,11 +4,29 @@
 #include <Arduino.h>
 #include "TeenyMenuItem.h"
 
+// Type of row indexes of menu pages: only virtual pages (see TeenyMenuPage constructor for virtual pages) have
+// more than 255 rows, up to 65535 or, if TEENYMENU_ROWS_32BIT is defined, up to 2^32-1
+#ifdef TEENYMENU_ROWS_32BIT
+typedef uint32_t teenyMenu_row_t;
+#else
+typedef uint16_t teenyMenu_row_t;
+#endif
+
+// Declaration of TeenyMenuRows type: provider of the rows of a virtual page, may be declared TEENYMENU_CONST constexpr
+struct TeenyMenuRows {
+  teenyMenu_row_t (*count)();                                // Return the count of rows
+  void (*text)(teenyMenu_row_t index, char* buf, byte len);  // Write text of row 'index' into 'buf' (at most 'len' characters + terminator)
+  void (*select)(teenyMenu_row_t index);                     // Called for TEENYMENU_KEY_RIGHT on row 'index', or nullptr
+};
+
 // Declaration of TeenyMenuPage class
 class TeenyMenuPage {
   template <class T>
   friend class TeenyMenu;
   friend class TeenyMenuItem;
+  friend class TeenyMenuIndex;
+  template <class S>
+  friend class TeenyMenuStore;
   public:
     /* 
       @param 'title_' - title of the menu page displayed at top of the screen
@@ -22,23 +40,81 @@ class TeenyMenuPage {
     */
     TeenyMenuPage(const char* title_ = "", void (*enterAction_)() = nullptr, void (*exitAction_)() = nullptr,
                                      void (*keyUpAction_)() = nullptr, void (*keyDownAction_)() = nullptr);
-    void setParentMenuPage(TeenyMenuPage& parentMenuPage);  // Specify parent level menu page (to know where to go back to when pressing Back button)
-    TeenyMenuPage* getParentMenuPage();                     // Get parent level menu page (to know where to go back to when pressing Back button)
+    /* 
+      Constructor for constant menu page with a fixed array of menu items
+      Items and the array may be declared TEENYMENU_CONST constexpr so that they stay in flash, e.g.
+        TEENYMENU_CONST constexpr TeenyMenuItem itemBrightness("Brightness", brightness);
+        TEENYMENU_CONST constexpr const TeenyMenuItem* settingsItems[] = { &itemBrightness, ... };
+        TeenyMenuPage settingsPage("SETTINGS", settingsItems);
+      The items and the array are not copied: the page object itself (title, actions, parent link, counts and the
+      pointer to the array) is all the RAM the page takes, plus its visibility index once an item is hidden.
+      Menu items can't be added to a constant page; hide and show them with hideMenuItem(index).
+      @param 'title_' - title of the menu page displayed at top of the screen
+      @param 'menuItems_' - array of pointers to the menu items of the page
+      @param 'count_' - length of the 'menuItems_' array (deduced when an array is supplied)
+      other parameters are the same as above
+    */
+    TeenyMenuPage(const char* title_, const TeenyMenuItem* const* menuItems_, byte count_,
+                  void (*enterAction_)() = nullptr, void (*exitAction_)() = nullptr,
+                  void (*keyUpAction_)() = nullptr, void (*keyDownAction_)() = nullptr);
+    template <size_t N>
+    TeenyMenuPage(const char* title_, const TeenyMenuItem* const (&menuItems_)[N],
+                  void (*enterAction_)() = nullptr, void (*exitAction_)() = nullptr,
+                  void (*keyUpAction_)() = nullptr, void (*keyDownAction_)() = nullptr)
+      : TeenyMenuPage(title_, menuItems_, N, enterAction_, exitAction_, keyUpAction_, keyDownAction_)
+    { }
+    /* 
+      Constructor for virtual menu page, e.g. to browse event logs or file lists with thousands of entries
+      Rows are not menu items: the page asks 'rows_' for the count of rows and for the text of a row only when
+      the row is drawn, so only the rows on screen are ever rendered and the page takes the same RAM for any count
+      Rows are navigated and scrolled like menu items, none of them is readonly; if rows are removed while the page
+      is shown call TeenyMenu::drawMenu()
+      Menu items can't be added to a virtual page
+      @param 'title_' - title of the menu page displayed at top of the screen
+      @param 'rows_' - provider of the rows of the page (see TeenyMenuRows)
+      other parameters are the same as above
+    */
+    TeenyMenuPage(const char* title_, const TeenyMenuRows& rows_, void (*enterAction_)() = nullptr, void (*exitAction_)() = nullptr);
+    // Parent level menu page, where the Back button goes to if the page was not entered from another page of the menu
+    // (the menu remembers the pages it went through, see TeenyMenuNav, and leaves the parent alone)
+    void setParentMenuPage(TeenyMenuPage& parentMenuPage);  // Specify parent level menu page
+    TeenyMenuPage* getParentMenuPage();                     // Get parent level menu page
     void setTitle(const char* title_);                      // Set title of the menu page
     const char* getTitle();                                 // Get title of the menu page
     void addMenuItem(TeenyMenuItem& menuItem);        // Add menu item to menu page
-    byte getCurrentItemNum();                         // Get currently selected (focused) menu item of the page
-    void resetCurrentItemNum();                       // Find first item that is not readonly or type TEENYMENU_ITEM_BACK
+    void addMenuItems(TeenyMenuItem* const* menuItems, byte count);  // Add array of menu items to menu page in one go
+    teenyMenu_row_t getDefaultItemNum();              // Find first item that is not readonly or type TEENYMENU_ITEM_BACK (focused when the page is entered)
+    teenyMenu_row_t getRowsCount();                   // Get count of visible menu items, or of rows of virtual page
+    boolean isVirtual();                              // Page was constructed with TeenyMenuRows
     TeenyMenuItem* getMenuItem(byte index, boolean total = false);
+    void hideMenuItem(byte index, boolean hide = true);  // Hide or show menu item by its index among all items of the page (including hidden ones)
+    boolean isMenuItemHidden(byte index);             // Get hidden state of menu item by its index among all items of the page
+    int getMenuItemNum(const TeenyMenuItem& menuItem);         // Find index of the supplied menu item among visible items, -1 if hidden or not on the page
+    int getMenuItemIndexTotal(const TeenyMenuItem& menuItem);  // Find index of the supplied menu item among all items (e.g. to hide items of
+                                                               // a constant page, which don't know their page), -1 if not on the page
   private:
     TeenyMenuPage* _parentMenuPage = nullptr;
     const char* title;
-    byte currentItemNum = 0;                          // Currently selected (focused) menu item of the page
     byte itemsCount = 0;                              // Items count excluding hidden ones
     byte itemsCountTotal = 0;                         // Items count incuding hidden ones
-    TeenyMenuItem* _menuItem;                         // First menu item of the page (the following ones are linked from within one another)
-    TeenyMenuItem* getCurrentMenuItem();
-    int getMenuItemNum(TeenyMenuItem& menuItem);      // Find index of the supplied menu item
+    TeenyMenuItem** _menuItems = nullptr;             // All menu items of the page in order of addition, including hidden ones
+    byte* _visibleTree = nullptr;                     // Fenwick tree of visible item counts over _menuItems (rank/select of visible items),
+                                                      // nullptr as long as no item of the page is hidden
+    byte _menuItemsCapacity = 0;                      // Allocated length of _menuItems and _visibleTree
+    boolean _menuItemsConst = false;                  // _menuItems is the constant array supplied to the constructor
+    const TeenyMenuRows* _rows = nullptr;             // Rows of virtual page, nullptr for pages of menu items
+    boolean reserveMenuItems(byte count);             // Make room for at least supplied count of menu items in total
+    boolean appendMenuItem(TeenyMenuItem& menuItem);  // Index menu item after the last one (except _visibleTree)
+    boolean buildVisibleTree();                       // Allocate (if needed) and fill _visibleTree from hidden state of the items
+    // Cursors of TeenyMenuNav point to items by their index among all items, so that they stay on their item when
+    // other items are hidden or shown
+    teenyMenu_row_t getCursorItemNum(teenyMenu_row_t cursor);  // Index of the item the cursor points to (the visible one before it if hidden)
+    teenyMenu_row_t getItemCursor(teenyMenu_row_t itemNum);    // Cursor pointing to the item with supplied index
+    void visibleTreeAdd(byte indexTotal, int delta);  // Update visible count of the item at supplied total index
+    byte visibleTreeRank(byte indexTotal);            // Count visible items before the supplied total index
+    int visibleTreeSelect(byte index);                // Find total index of the visible item with supplied index
+    boolean isMenuItemVisible(byte indexTotal);
+    void setMenuItemVisible(byte indexTotal, boolean visible);
     void hideMenuItem(TeenyMenuItem& menuItem);
     void showMenuItem(TeenyMenuItem& menuItem);
     void (*enterAction)();
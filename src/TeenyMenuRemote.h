@@ -0,0 +1,231 @@
+#ifndef HEADER_TEENYMENUREMOTE
+#define HEADER_TEENYMENUREMOTE
+
+#include "TeenyMenu.h"
+
+// Longest command line TeenyMenuRemote takes (longer lines are answered with an error)
+#ifndef TEENYMENU_REMOTE_LINE_LEN
+#define TEENYMENU_REMOTE_LINE_LEN 32
+#endif
+
+// Longest row text TeenyMenuRemote sends (see TeenyMenu::getRowText())
+#ifndef TEENYMENU_REMOTE_TEXT_LEN
+#define TEENYMENU_REMOTE_TEXT_LEN 32
+#endif
+
+/*
+  Declaration of TeenyMenuRemote class: drives a TeenyMenu through a line-oriented text protocol over a stream
+  (e.g. Serial), for automated tests and field diagnostics, also of a menu without a screen (see TeenyMenuFrame)
+  Commands, one per line ended by '\n' or '\r':
+    K <keys>  press keys in order, U(p) D(own) L(eft) R(ight), e.g. "K DDR"
+    T         screen as text: "# <page title>", then a line per row on screen (see TeenyMenu::getRowText()),
+              starting with "> " for the current row and with "  " for the others
+    B         frame buffer (see TeenyMenu::setFrameBuffer()) in hex, a line of two digits per column for each
+              8-pixel page, bit 0 of a column byte on top
+    V [n]     "= <value>" of value item n of the current page (the current item if n is left out), the option
+              index for a select (see TeenyMenu::getRowValue())
+    S         "S <current item> <edit mode 0/1> <pages on the way back>"
+  Each command is answered with "OK <us>", the time the command took in microseconds (output included), or
+  with "ERR <reason>", after its output lines
+  'T' - display class of the menu
+  'S' - stream class with the interface of Arduino Stream (Serial can be passed as it is):
+    int available(), int read(), size_t print(const char* str)
+*/
+template <class T, class S>
+class TeenyMenuRemote {
+  public:
+    TeenyMenuRemote(TeenyMenu<T>& menu_, S& stream_)
+      : _menu(menu_)
+      , _stream(stream_)
+    { }
+
+    // service() must be called from loop(), it reads the characters available from the stream and runs the
+    // commands they complete
+    // Returns the count of commands run
+    byte service() {
+      byte commands = 0;
+      while (_stream.available() > 0) {
+        int c = _stream.read();
+        if (c < 0) {
+          break;
+        }
+        if (c == '\n' || c == '\r') {
+          if (_lineLength > 0 || _lineOverflow) {
+            runCommand();
+            commands++;
+          }
+          _lineLength = 0;
+          _lineOverflow = false;
+        } else if (_lineLength < TEENYMENU_REMOTE_LINE_LEN) {
+          _line[_lineLength++] = (char)c;
+        } else {
+          _lineOverflow = true;
+        }
+      }
+      return(commands);
+    }
+
+    // Commands run since construction
+    uint32_t getCommandsCount() {
+      return(_commandsCount);
+    }
+
+  private:
+    TeenyMenu<T>& _menu;
+    S& _stream;
+    char _line[TEENYMENU_REMOTE_LINE_LEN+1];
+    byte _lineLength = 0;
+    bool _lineOverflow = false;
+    uint32_t _commandsCount = 0;
+
+    void runCommand() {
+      uint32_t start = micros();
+      _commandsCount++;
+      _line[_lineLength] = '\0';
+      const char* error = nullptr;
+      if (_lineOverflow) {
+        error = "line too long";
+      } else {
+        switch (_line[0]) {
+          case 'K':
+            error = pressKeys(_line + 1);
+            break;
+          case 'T':
+            sendText();
+            break;
+          case 'B':
+            error = sendBitmap();
+            break;
+          case 'V':
+            error = sendValue(_line + 1);
+            break;
+          case 'S':
+            sendState();
+            break;
+          default:
+            error = "unknown command";
+            break;
+        }
+      }
+      if (error != nullptr) {
+        _stream.print("ERR ");
+        _stream.print(error);
+      } else {
+        _stream.print("OK ");
+        printNumber(micros() - start);
+      }
+      _stream.print("\n");
+    }
+
+    // Keys are checked before any of them is pressed
+    const char* pressKeys(const char* keys) {
+      for (const char* key=keys; *key; key++) {
+        if (*key != ' ' && getKeyCode(*key) == TEENYMENU_KEY_NONE) {
+          return("unknown key");
+        }
+      }
+      for (const char* key=keys; *key; key++) {
+        if (*key != ' ') {
+          _menu.registerKeyPress(getKeyCode(*key));
+        }
+      }
+      return(nullptr);
+    }
+
+    static byte getKeyCode(char key) {
+      switch (key) {
+        case 'U':
+          return(TEENYMENU_KEY_UP);
+        case 'D':
+          return(TEENYMENU_KEY_DOWN);
+        case 'L':
+          return(TEENYMENU_KEY_LEFT);
+        case 'R':
+          return(TEENYMENU_KEY_RIGHT);
+      }
+      return(TEENYMENU_KEY_NONE);
+    }
+
+    void sendText() {
+      char text[TEENYMENU_REMOTE_TEXT_LEN+1];
+      _stream.print("# ");
+      _stream.print(_menu._nav->page->getTitle());
+      _stream.print("\n");
+      teenyMenu_row_t firstItemNum = _menu.getFirstItemNum();
+      teenyMenu_row_t currentItemNum = _menu.getCurrentItemNum();
+      for (byte i=0; i<_menu._menuItemsPerScreen && _menu.getRowText(firstItemNum + i, text, TEENYMENU_REMOTE_TEXT_LEN); i++) {
+        _stream.print((firstItemNum + i == currentItemNum) ? "> " : "  ");
+        _stream.print(text);
+        _stream.print("\n");
+      }
+    }
+
+    const char* sendBitmap() {
+      const uint8_t* frame = _menu._displayPV.getFrameBuffer();
+      if (frame == nullptr) {
+        return("no frame buffer");
+      }
+      static const char digits[] = "0123456789ABCDEF";
+      int16_t width = _menu._display.width();
+      int16_t pages = (_menu._display.height() + 7) / 8;
+      // Sent in pieces of 16 columns, to keep the stack small
+      char hex[16*2+1];
+      for (int16_t page=0; page<pages; page++) {
+        for (int16_t col=0; col<width; col+=16) {
+          byte count = min(16, width - col);
+          for (byte i=0; i<count; i++) {
+            hex[i*2] = digits[frame[col + i] >> 4];
+            hex[i*2+1] = digits[frame[col + i] & 0x0F];
+          }
+          hex[count*2] = '\0';
+          _stream.print(hex);
+        }
+        _stream.print("\n");
+        frame += width;
+      }
+      return(nullptr);
+    }
+
+    const char* sendValue(const char* arg) {
+      while (*arg == ' ') {
+        arg++;
+      }
+      teenyMenu_row_t itemNum = _menu.getCurrentItemNum();
+      if (*arg != '\0') {
+        char* end;
+        unsigned long num = strtoul(arg, &end, 10);
+        if (end == arg || *end != '\0') {
+          return("bad item number");
+        }
+        itemNum = (num < (teenyMenu_row_t)-1) ? num : (teenyMenu_row_t)-1;
+      }
+      int32_t value;
+      if (!_menu.getRowValue(itemNum, value)) {
+        return("not a value item");
+      }
+      _stream.print("= ");
+      if (value < 0) {
+        _stream.print("-");
+      }
+      printNumber((value < 0) ? 0u - (uint32_t)value : (uint32_t)value);
+      _stream.print("\n");
+      return(nullptr);
+    }
+
+    void sendState() {
+      _stream.print("S ");
+      printNumber(_menu.getCurrentItemNum());
+      _stream.print(_menu._nav->editValueMode ? " 1 " : " 0 ");
+      printNumber(_menu._nav->depth + _menu._nav->depthBeyond);
+      _stream.print("\n");
+    }
+
+    // Numbers are formatted by TeenyPrtFmt, so that the remote doesn't pull printf in
+    void printNumber(uint32_t value) {
+      char digits[11];
+      digits[TeenyPrtFmt::fmt_uint(digits, sizeof(digits)-1, value)] = '\0';
+      _stream.print(digits);
+    }
+};
+
+#endif
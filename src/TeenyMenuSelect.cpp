@@ -2,23 +2,86 @@
 #include "TeenyMenuSelect.h"
 #include "TeenyMenuConstants.h"
 
-TeenyMenuSelect::TeenyMenuSelect(byte length_, SelectOptionByte* options_)
+TeenyMenuSelect::TeenyMenuSelect(byte length_, SelectOptionByte* options_, boolean indexed_)
   : _type(TEENYMENU_VAL_BYTE)
   , _length(length_)
   , _options(options_)
-{ }
+{
+  buildIndex(indexed_);
+}
 
-TeenyMenuSelect::TeenyMenuSelect(byte length_, SelectOptionInt* options_)
+TeenyMenuSelect::TeenyMenuSelect(byte length_, SelectOptionInt* options_, boolean indexed_)
   : _type(TEENYMENU_VAL_INTEGER)
   , _length(length_)
   , _options(options_)
-{ }
+{
+  buildIndex(indexed_);
+}
 
-TeenyMenuSelect::TeenyMenuSelect(byte length_, SelectOptionInt32t* options_)
+TeenyMenuSelect::TeenyMenuSelect(byte length_, SelectOptionInt32t* options_, boolean indexed_)
   : _type(TEENYMENU_VAL_INT32T)
   , _length(length_)
   , _options(options_)
-{ }
+{
+  buildIndex(indexed_);
+}
+
+TeenyMenuSelect::~TeenyMenuSelect() {
+  free(_sortedIndex);
+}
+
+void TeenyMenuSelect::buildIndex(boolean indexed) {
+  // Options already sorted by value can be binary searched as they are
+  _sorted = true;
+  for (byte i=1; i<_length; i++) {
+    if (getOptionValue(i-1) > getOptionValue(i)) {
+      _sorted = false;
+      break;
+    }
+  }
+  if (_sorted || !indexed) {
+    return;
+  }
+  _sortedIndex = (byte*)malloc(_length);
+  if (_sortedIndex == nullptr) {
+    return;
+  }
+  // Stable insertion sort, so that among equal values the first option is found (as with linear search)
+  for (byte i=0; i<_length; i++) {
+    byte j = i;
+    int32_t value = getOptionValue(i);
+    while (j > 0 && getOptionValue(_sortedIndex[j-1]) > value) {
+      _sortedIndex[j] = _sortedIndex[j-1];
+      j--;
+    }
+    _sortedIndex[j] = i;
+  }
+  _sorted = true;
+}
+
+int32_t TeenyMenuSelect::getOptionValue(byte index) {
+  switch (_type) {
+    case TEENYMENU_VAL_BYTE:
+      return ((SelectOptionByte*)_options)[index].val_byte;
+    case TEENYMENU_VAL_INTEGER:
+      return ((SelectOptionInt*)_options)[index].val_int;
+    case TEENYMENU_VAL_INT32T:
+      return ((SelectOptionInt32t*)_options)[index].val_int32t;
+  }
+  return 0;
+}
+
+int32_t TeenyMenuSelect::getVariableValue(void* variable) {
+  switch (_type) {
+    case TEENYMENU_VAL_BYTE:
+      return *(byte*)variable;
+    case TEENYMENU_VAL_INTEGER:
+      return *(int*)variable;
+    case TEENYMENU_VAL_INT32T:
+      return *(int32_t*)variable;
+  }
+  return 0;
+}
 
 byte TeenyMenuSelect::getType() {
   return _type;
@@ -29,25 +92,52 @@ byte TeenyMenuSelect::getLength() {
 }
 
 int TeenyMenuSelect::getSelectedOptionNum(void* variable) {
-  SelectOptionByte*   optsByte   = (SelectOptionByte*)_options;
-  SelectOptionInt*    optsInt    = (SelectOptionInt*)_options;
-  SelectOptionInt32t* optsInt32t = (SelectOptionInt32t*)_options;
-  boolean found = false;
-  for (byte i=0; i<_length; i++) {
+  int32_t value = getVariableValue(variable);
+  // Most lookups are redraws of an unchanged variable
+  if (_lastOptionNum < _length && getOptionValue(_lastOptionNum) == value) {
+    return _lastOptionNum;
+  }
+  int optionNum = -1;
+  if (_sorted) {
+    // Binary search for the first option (in value order) not less than the variable
+    byte lo = 0;
+    byte hi = _length;
+    while (lo < hi) {
+      byte mid = lo + (hi - lo) / 2;
+      if (getOptionValue((_sortedIndex != nullptr) ? _sortedIndex[mid] : mid) < value) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo < _length) {
+      byte index = (_sortedIndex != nullptr) ? _sortedIndex[lo] : lo;
+      if (getOptionValue(index) == value) {
+        optionNum = index;
+      }
+    }
+  } else {
+    SelectOptionByte*   optsByte   = (SelectOptionByte*)_options;
+    SelectOptionInt*    optsInt    = (SelectOptionInt*)_options;
+    SelectOptionInt32t* optsInt32t = (SelectOptionInt32t*)_options;
+    byte i = 0;
     switch (_type) {
       case TEENYMENU_VAL_BYTE:
-        if (optsByte[i].val_byte == *(byte*)variable) { found = true; }
+        while (i<_length && optsByte[i].val_byte != value) { i++; }
         break;
       case TEENYMENU_VAL_INTEGER:
-        if (optsInt[i].val_int == *(int*)variable) { found = true; }
+        while (i<_length && optsInt[i].val_int != value) { i++; }
         break;
       case TEENYMENU_VAL_INT32T:
-        if (optsInt32t[i].val_int32t == *(int32_t*)variable) { found = true; }
+        while (i<_length && optsInt32t[i].val_int32t != value) { i++; }
         break;
     }
-    if (found) { return i; }
+    if (i<_length) { optionNum = i; }
+  }
+  if (optionNum > -1) {
+    _lastOptionNum = optionNum;
   }
-  if (!found) { return -1; }
+  return optionNum;
 }
 
 char* TeenyMenuSelect::getSelectedOptionName(void* variable) {
@@ -23,18 +23,34 @@ struct SelectOptionInt32t {
 class TeenyMenuSelect {
   template <class T>
   friend class TeenyMenu;
+  friend class TeenyMenuIndex;
+  template <class S>
+  friend class TeenyMenuStore;
   public:
     /* 
       @param 'length_' - length of the 'options_' array
       @param 'options_' - array of the available options
+      @param 'indexed_' (optional) - build a value-sorted index of the options so that the selected option is found
+      with binary search (options that are already sorted by value are searched in place without an index)
+      default false
     */
-    TeenyMenuSelect(byte length_, SelectOptionByte* options_);
-    TeenyMenuSelect(byte length_, SelectOptionInt* options_);
-    TeenyMenuSelect(byte length_, SelectOptionInt32t* options_);
+    TeenyMenuSelect(byte length_, SelectOptionByte* options_, boolean indexed_ = false);
+    TeenyMenuSelect(byte length_, SelectOptionInt* options_, boolean indexed_ = false);
+    TeenyMenuSelect(byte length_, SelectOptionInt32t* options_, boolean indexed_ = false);
+    ~TeenyMenuSelect();
+    // The index belongs to the select, so a select is not copied
+    TeenyMenuSelect(const TeenyMenuSelect&) = delete;
+    TeenyMenuSelect& operator=(const TeenyMenuSelect&) = delete;
   private:
     byte _type;
     byte _length;
     void* _options;
+    byte _lastOptionNum = 0;           // Option matched by the last lookup (checked before searching)
+    boolean _sorted = false;           // Options can be binary searched (in place or through _sortedIndex)
+    byte* _sortedIndex = nullptr;      // Option indexes ordered by value, nullptr if options are sorted in place
+    void buildIndex(boolean indexed);
+    int32_t getOptionValue(byte index);
+    int32_t getVariableValue(void* variable);
     byte getType();
     byte getLength();
     int getSelectedOptionNum(void* variable);
@@ -0,0 +1,284 @@
+#ifndef HEADER_TEENYMENUSTORE
+#define HEADER_TEENYMENUSTORE
+
+#include <Arduino.h>
+#include "TeenyMenuPage.h"
+#include "TeenyMenuSelect.h"
+#include "TeenyMenuConstants.h"
+
+// Most variables a TeenyMenuStore keeps (32 at most)
+#ifndef TEENYMENU_STORE_VARS
+#define TEENYMENU_STORE_VARS 32
+#endif
+
+// Most bytes of the variables a TeenyMenuStore keeps, altogether
+#ifndef TEENYMENU_STORE_LEN
+#define TEENYMENU_STORE_LEN 64
+#endif
+
+// Most menu pages TeenyMenuStore::addMenuPage() goes through
+#ifndef TEENYMENU_STORE_PAGES
+#define TEENYMENU_STORE_PAGES 16
+#endif
+
+// Time source of the quiet period of TeenyMenuStore (millis() unless defined otherwise)
+#ifndef TEENYMENU_STORE_CLOCK
+#define TEENYMENU_STORE_CLOCK() millis()
+#endif
+
+/*
+  Declaration of TeenyMenuStore class: keeps the variables linked to menu items in EEPROM (or any storage with
+  the same interface), in place of saveAction callbacks writing each variable as soon as it is saved
+  The store watches the registered variables from service(), and once none of them changed for the quiet period
+  writes all of them as one record. Records are written to the next slot of the storage area in turn, so that
+  each byte of the area is written once every (area length / record length) records, and carry a sequence
+  number and a CRC, so that restore() finds the latest complete record in one pass over the area; a record cut
+  short by a reset is skipped and the previous one restored
+  Record: 0xA5, sequence (2 bytes), layout (2 bytes, CRC of the variable sizes), variables, CRC-16/CCITT (2 bytes)
+  'S' - storage class with the interface of Arduino EEPROM (EEPROM can be passed as it is):
+    uint8_t read(int address), void update(int address, uint8_t value) (writes only if the value differs)
+*/
+template <class S>
+class TeenyMenuStore {
+  public:
+    /*
+      @param 'storage_' - storage the records are written to
+      @param 'address_' - first address of the storage area of the store
+      @param 'length_' - length of the storage area, should hold at least two records
+      @param 'quietMs_' (optional) - time in ms the variables must stay unchanged before they are written
+      default 2000
+    */
+    TeenyMenuStore(S& storage_, uint16_t address_, uint16_t length_, uint16_t quietMs_ = 2000)
+      : _storage(storage_)
+      , _address(address_)
+      , _length(length_)
+      , _quietMs(quietMs_)
+    { }
+
+    // Register the variables linked to the (not readonly) items of the page and of the pages it links to
+    // Returns false if any of them didn't fit (see TEENYMENU_STORE_VARS, TEENYMENU_STORE_LEN, TEENYMENU_STORE_PAGES
+    // and addVariable())
+    bool addMenuPage(TeenyMenuPage& page) {
+      TeenyMenuPage* visited[TEENYMENU_STORE_PAGES];
+      byte visitedCount = 0;
+      return(addMenuPage(page, visited, visitedCount));
+    }
+
+    // Register a variable of 'size' bytes, variables already registered are skipped
+    // Register all variables before restore(), always in the same order: records of another layout are not restored
+    // Returns false if the variable didn't fit, also when the storage area couldn't hold two records with it
+    bool addVariable(void* variable, byte size) {
+      for (byte i=0; i<_varsCount; i++) {
+        if (_vars[i] == variable) {
+          return(true);
+        }
+      }
+      if (_varsCount == TEENYMENU_STORE_VARS || _recordLen + size > TEENYMENU_STORE_LEN ||
+          (uint32_t)(getSlotLength() + size) * 2 > _length) {
+        return(false);
+      }
+      _vars[_varsCount] = (uint8_t*)variable;
+      _sizes[_varsCount] = size;
+      memcpy(_record + _recordLen, variable, size);
+      _varsCount++;
+      _recordLen += size;
+      _layout = crc16(&size, 1, _layout);
+      return(true);
+    }
+
+    // Load the variables from the latest complete record, call once at boot after registering the variables
+    // Returns false if the storage area holds no complete record of the current layout (variables are left alone)
+    bool restore() {
+      uint16_t slotLen = getSlotLength();
+      uint16_t slotsCount = getSlotsCount();
+      bool found = false;
+      for (uint16_t slot=0; slot<slotsCount; slot++) {
+        int address = _address + slot * slotLen;
+        uint8_t header[TEENYMENU_STORE_HEADER];
+        for (byte i=0; i<TEENYMENU_STORE_HEADER; i++) {
+          header[i] = _storage.read(address + i);
+        }
+        uint16_t sequence = header[1] | (header[2] << 8);
+        if (header[0] != TEENYMENU_STORE_MAGIC || (header[3] | (header[4] << 8)) != _layout ||
+            (found && (int16_t)(sequence - _sequence) <= 0)) {
+          continue;
+        }
+        uint16_t crc = crc16(header, TEENYMENU_STORE_HEADER, 0xFFFF);
+        for (uint16_t i=0; i<_recordLen; i++) {
+          uint8_t b = _storage.read(address + TEENYMENU_STORE_HEADER + i);
+          crc = crc16(&b, 1, crc);
+        }
+        uint16_t crcStored = _storage.read(address + TEENYMENU_STORE_HEADER + _recordLen) |
+                             (_storage.read(address + TEENYMENU_STORE_HEADER + _recordLen + 1) << 8);
+        if (crc == crcStored) {
+          found = true;
+          _slot = slot;
+          _sequence = sequence;
+        }
+      }
+      if (!found) {
+        // The first record goes to the first slot
+        _slot = slotsCount - 1;
+        return(false);
+      }
+      int address = _address + _slot * slotLen + TEENYMENU_STORE_HEADER;
+      for (uint16_t i=0; i<_recordLen; i++) {
+        _record[i] = _storage.read(address + i);
+      }
+      uint8_t* value = _record;
+      for (byte i=0; i<_varsCount; i++) {
+        memcpy(_vars[i], value, _sizes[i]);
+        value += _sizes[i];
+      }
+      _dirty = 0;
+      return(true);
+    }
+
+    // service() must be called from loop(), it notes which variables changed and writes the record once they
+    // stay unchanged for the quiet period
+    // Returns true if a record was written
+    bool service() {
+      uint32_t now = TEENYMENU_STORE_CLOCK();
+      uint8_t* value = _record;
+      for (byte i=0; i<_varsCount; i++) {
+        if (memcmp(value, _vars[i], _sizes[i]) != 0) {
+          memcpy(value, _vars[i], _sizes[i]);
+          _dirty |= (uint32_t)1 << i;
+          _changeTime = now;
+        }
+        value += _sizes[i];
+      }
+      if (_dirty != 0 && (uint32_t)(now - _changeTime) >= _quietMs) {
+        return(writeRecord());
+      }
+      return(false);
+    }
+
+    // Write the record now if any variable changed since the last one (e.g. before going to sleep)
+    // Returns true if a record was written
+    bool flush() {
+      _changeTime = TEENYMENU_STORE_CLOCK() - _quietMs;
+      return(service());
+    }
+
+    // Any variable changed since the last record was written (as of the last service() call)
+    bool isDirty() {
+      return(_dirty != 0);
+    }
+
+    // Bit n set - the n-th variable registered changed since the last record was written
+    uint32_t getDirtyVariables() {
+      return(_dirty);
+    }
+
+    byte getVariablesCount() {
+      return(_varsCount);
+    }
+
+    // Length of a record and count of records the storage area holds
+    uint16_t getSlotLength() {
+      return(TEENYMENU_STORE_HEADER + _recordLen + 2);
+    }
+
+    uint16_t getSlotsCount() {
+      return(_length / getSlotLength());
+    }
+
+  private:
+    static const byte TEENYMENU_STORE_MAGIC = 0xA5;
+    static const byte TEENYMENU_STORE_HEADER = 5;
+
+    S& _storage;
+    uint16_t _address;
+    uint16_t _length;
+    uint16_t _quietMs;
+    uint8_t* _vars[TEENYMENU_STORE_VARS];
+    byte _sizes[TEENYMENU_STORE_VARS];
+    byte _varsCount = 0;
+    uint8_t _record[TEENYMENU_STORE_LEN];  // Values of the variables as of the last service() call
+    uint16_t _recordLen = 0;
+    uint16_t _layout = 0xFFFF;
+    uint32_t _dirty = 0;                     // Bit n set - variable n changed since the last record
+    uint32_t _changeTime = 0;                // TEENYMENU_STORE_CLOCK() when a variable changed last
+    uint16_t _slot = 0;                      // Slot of the last record
+    uint16_t _sequence = 0;                  // Sequence number of the last record
+
+    bool addMenuPage(TeenyMenuPage& page, TeenyMenuPage** visited, byte& visitedCount) {
+      // Pages may link to each other, go through each one once
+      for (byte i=0; i<visitedCount; i++) {
+        if (visited[i] == &page) {
+          return(true);
+        }
+      }
+      if (visitedCount == TEENYMENU_STORE_PAGES) {
+        return(false);
+      }
+      visited[visitedCount++] = &page;
+      bool added = true;
+      for (byte i=0; i<page.itemsCountTotal; i++) {
+        TeenyMenuItem* menuItemTmp = page.getMenuItem(i, true);
+        if (menuItemTmp->type == TEENYMENU_ITEM_VAL && !menuItemTmp->readonly) {
+          byte linkedType = menuItemTmp->linkedType;
+          if (linkedType == TEENYMENU_VAL_SELECT) {
+            linkedType = menuItemTmp->var.select->getType();
+          }
+          byte size = (linkedType == TEENYMENU_VAL_TYPED) ? menuItemTmp->var.ops->size : getVariableSize(linkedType);
+          added &= addVariable(menuItemTmp->var.linkedVariable, size);
+        } else if (menuItemTmp->type == TEENYMENU_ITEM_LINK && menuItemTmp->linkedPage != nullptr) {
+          added &= addMenuPage(*menuItemTmp->linkedPage, visited, visitedCount);
+        }
+      }
+      return(added);
+    }
+
+    static byte getVariableSize(byte linkedType) {
+      switch (linkedType) {
+        case TEENYMENU_VAL_BYTE:
+          return(sizeof(byte));
+        case TEENYMENU_VAL_INTEGER:
+          return(sizeof(int));
+        case TEENYMENU_VAL_INT32T:
+          return(sizeof(int32_t));
+        case TEENYMENU_VAL_BOOLEAN:
+          return(sizeof(boolean));
+      }
+      return(0);
+    }
+
+    // Write the record to the slot after the last one
+    // Returns false if the storage area is shorter than a record (nothing is written)
+    bool writeRecord() {
+      if (getSlotsCount() == 0) {
+        return(false);
+      }
+      _slot = (_slot + 1 < getSlotsCount()) ? _slot + 1 : 0;
+      _sequence++;
+      uint8_t header[TEENYMENU_STORE_HEADER] = { TEENYMENU_STORE_MAGIC, (uint8_t)_sequence, (uint8_t)(_sequence >> 8),
+                                                 (uint8_t)_layout, (uint8_t)(_layout >> 8) };
+      uint16_t crc = crc16(_record, _recordLen, crc16(header, TEENYMENU_STORE_HEADER, 0xFFFF));
+      int address = _address + _slot * getSlotLength();
+      for (byte i=0; i<TEENYMENU_STORE_HEADER; i++) {
+        _storage.update(address++, header[i]);
+      }
+      for (uint16_t i=0; i<_recordLen; i++) {
+        _storage.update(address++, _record[i]);
+      }
+      _storage.update(address++, (uint8_t)crc);
+      _storage.update(address, (uint8_t)(crc >> 8));
+      _dirty = 0;
+      return(true);
+    }
+
+    // CRC-16/CCITT of 'len' bytes, continuing from 'crc'
+    static uint16_t crc16(const uint8_t* data, uint16_t len, uint16_t crc) {
+      while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (byte i=0; i<8; i++) {
+          crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+      }
+      return(crc);
+    }
+};
+
+#endif
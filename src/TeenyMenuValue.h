@@ -0,0 +1,211 @@
+#ifndef HEADER_TEENYMENUVALUE
+#define HEADER_TEENYMENUVALUE
+
+#include <Arduino.h>
+#include <float.h>
+#include "TeenyMenuItem.h"
+#include "TeenyPrtVal.h"
+
+// Count of decimals float values of TeenyMenuValue items are drawn with
+#ifndef TEENYMENU_VALUE_DECIMALS
+#define TEENYMENU_VALUE_DECIMALS 2
+#endif
+
+// Declaration of TeenyMenuValueTraits type: limits, int64_t conversion (see TeenyMenuValueOps) and formatting of the
+// variable types of TeenyMenuValue items, picked at compile time. This one is for integer types, 8 to 64 bits wide
+// (unsigned ones up to 32 bits, so that their values fit into int64_t)
+template <class V>
+struct TeenyMenuValueTraits {
+  static_assert((V)3 / 2 == 1, "TeenyMenuValue supports integer types and float");
+  static_assert((V)-1 < (V)0 || sizeof(V) < sizeof(int64_t), "TeenyMenuValue supports unsigned types up to 32 bits");
+  static constexpr boolean isSigned() {
+    return((V)-1 < (V)0);
+  }
+  static constexpr V highest() {
+    return(isSigned() ? (V)(((uint64_t)1 << (sizeof(V) * 8 - 1)) - 1) : (V)-1);
+  }
+  static constexpr V lowest() {
+    return(isSigned() ? (V)(-highest() - 1) : (V)0);
+  }
+  static constexpr boolean isInteger() {
+    return(true);
+  }
+  static int64_t toValue(V variable) {
+    return(variable);
+  }
+  static V fromValue(int64_t value) {
+    return((V)value);
+  }
+  // 'count' steps from 'from' reach 'to' (not below 'from'), the distance is taken in uint64_t and divided rather
+  // than the steps multiplied, so that neither can overflow (steps landing on 'to' exactly count as not reaching it,
+  // their sum is 'to' then)
+  static boolean reaches(V from, V to, V step, uint32_t count) {
+    return(((uint64_t)to - (uint64_t)from) / count < (uint64_t)step);
+  }
+  // 'count' steps added or subtracted, for values they don't take out of V (see reaches())
+  static V add(V variable, V step, uint32_t count) {
+    return((V)((uint64_t)variable + (uint64_t)step * count));
+  }
+  static V subtract(V variable, V step, uint32_t count) {
+    return((V)((uint64_t)variable - (uint64_t)step * count));
+  }
+  static void format(int64_t value, char* buf, int len) {
+    // Only the branch matching the size and signedness of V is left after compiling
+    if (sizeof(V) < sizeof(int32_t) || (sizeof(V) == sizeof(int32_t) && isSigned())) {
+      TeenyPrtFmt::fmt_int(buf, len, (int32_t)value);
+    } else if (sizeof(V) == sizeof(int32_t)) {
+      TeenyPrtFmt::fmt_uint(buf, len, (uint32_t)value);
+    } else {
+      TeenyPrtFmt::fmt_int64(buf, len, value);
+    }
+  }
+};
+
+// float, passed as int64_t by its bytes and formatted by TeenyPrtFmt::fmt_float() (double is not supported, as
+// fmt_float() formats float values only)
+template <>
+struct TeenyMenuValueTraits<float> {
+  static constexpr float highest() {
+    return(FLT_MAX);
+  }
+  static constexpr float lowest() {
+    return(-FLT_MAX);
+  }
+  static constexpr boolean isInteger() {
+    return(false);
+  }
+  static int64_t toValue(float variable) {
+    int64_t value = 0;
+    memcpy(&value, &variable, sizeof(float));
+    return(value);
+  }
+  static float fromValue(int64_t value) {
+    float variable;
+    memcpy(&variable, &value, sizeof(float));
+    return(variable);
+  }
+  static boolean reaches(float from, float to, float step, uint32_t count) {
+    return(to - from <= step * count);
+  }
+  static float add(float variable, float step, uint32_t count) {
+    return(variable + step * count);
+  }
+  static float subtract(float variable, float step, uint32_t count) {
+    return(variable - step * count);
+  }
+  static void format(int64_t value, char* buf, int len) {
+    TeenyPrtFmt::fmt_float(buf, len, fromValue(value), TEENYMENU_VALUE_DECIMALS);
+  }
+};
+
+// Declaration of TeenyMenuValue class: menu item that represents a variable of type V (integer types 8 to 64 bits wide,
+// unsigned ones up to 32 bits, or float), edited in steps within a range. The variable is read, formatted,
+// stepped and written by code generated for V (see TeenyMenuValueOps), without switching on its type nor reading it
+// through a pointer of another type, e.g.
+//   TeenyMenuValue<uint16_t> menuItemRate("Rate", rate, 100, 5000, 50, applyRate);
+//   TeenyMenuValue<float> menuItemGain("Gain", gain, 0.0f, 2.0f, 0.05f);
+// Like TeenyMenuItem, constructors are constexpr, so constant items can be kept in flash
+// Edit steps (see TeenyMenuItem::setEditSteps()) count steps of the item, e.g. {1, 10, 100} with a step of 0.05f
+// moves a float value by 0.05, 0.5 and 5
+template <class V>
+class TeenyMenuValue : public TeenyMenuItem {
+  typedef TeenyMenuValueTraits<V> Traits;
+  public:
+    /*
+      Constructors for menu item that represents variable, w/o range (the range of type V), stepped by 1
+      @param 'title_' - title of the menu item displayed on the screen
+      @param 'linkedVariable_' - reference to variable that menu item is associated with
+      @param 'saveAction_' - pointer to callback function executed when associated variable is successfully saved
+      @param 'readonly_' (optional) - set readonly mode for variable that menu item is associated with
+      values TEENYMENU_READONLY (alias for true)
+      default false
+    */
+    constexpr TeenyMenuValue(const char* title_, V& linkedVariable_, void (*saveAction_)())
+      : TeenyMenuValue(title_, linkedVariable_, Traits::lowest(), Traits::highest(), 1, saveAction_)
+    { }
+
+    constexpr TeenyMenuValue(const char* title_, V& linkedVariable_, boolean readonly_ = false)
+      : TeenyMenuValue(title_, linkedVariable_, Traits::lowest(), Traits::highest(), 1, nullptr, readonly_)
+    { }
+    /*
+      Constructor for menu item that represents variable, w/ min/max range and step
+      @param 'title_' - title of the menu item displayed on the screen
+      @param 'linkedVariable_' - reference to variable that menu item is associated with
+      @param 'rangeMin_' - range minimum value
+      @param 'rangeMax_' - range maximum value
+      @param 'step_' - value added or subtracted by each press of TEENYMENU_KEY_UP/DOWN while editing (greater than 0)
+      @param 'saveAction_' (optional) - pointer to callback function executed when associated variable is successfully saved
+      @param 'readonly_' (optional) - set readonly mode for variable that menu item is associated with
+      values TEENYMENU_READONLY (alias for true)
+      default false
+    */
+    constexpr TeenyMenuValue(const char* title_, V& linkedVariable_, V rangeMin_, V rangeMax_, V step_,
+                             void (*saveAction_)() = nullptr, boolean readonly_ = false)
+      : TeenyMenuItem(title_, &linkedVariable_, ops, saveAction_, readonly_)
+      , rangeMin(rangeMin_)
+      , rangeMax(rangeMax_)
+      , step(step_)
+      , editSteps(nullptr)
+      , editStepsCount(0)
+    { }
+  private:
+    V rangeMin;
+    V rangeMax;
+    V step;
+    const int32_t* editSteps;
+    byte editStepsCount;
+    static const TeenyMenuValueOps ops;
+
+    static int64_t getValue(const void* linkedVariable) {
+      return(Traits::toValue(*(const V*)linkedVariable));
+    }
+
+    static void setValue(void* linkedVariable, int64_t value) {
+      *(V*)linkedVariable = Traits::fromValue(value);
+    }
+
+    static int64_t stepValue(const TeenyMenuItem* item, int64_t value, int32_t steps) {
+      const TeenyMenuValue* valueItem = static_cast<const TeenyMenuValue*>(item);
+      V variable = Traits::fromValue(value);
+      uint32_t count = (steps < 0) ? 0u - (uint32_t)steps : (uint32_t)steps;
+      if (variable < valueItem->rangeMin) {
+        variable = valueItem->rangeMin;
+      } else if (variable > valueItem->rangeMax) {
+        variable = valueItem->rangeMax;
+      } else if (steps > 0) {
+        // Compared to the room left rather than added first, so that the sum can't overflow V
+        variable = Traits::reaches(variable, valueItem->rangeMax, valueItem->step, count) ? valueItem->rangeMax :
+                   Traits::add(variable, valueItem->step, count);
+      } else if (steps < 0) {
+        variable = Traits::reaches(valueItem->rangeMin, variable, valueItem->step, count) ? valueItem->rangeMin :
+                   Traits::subtract(variable, valueItem->step, count);
+      }
+      return(Traits::toValue(variable));
+    }
+
+    static const int32_t* getItemEditSteps(const TeenyMenuItem* item, byte& editStepsCount_) {
+      const TeenyMenuValue* valueItem = static_cast<const TeenyMenuValue*>(item);
+      editStepsCount_ = valueItem->editStepsCount;
+      return(valueItem->editSteps);
+    }
+
+    static void setItemEditSteps(TeenyMenuItem* item, const int32_t* editSteps_, byte editStepsCount_) {
+      TeenyMenuValue* valueItem = static_cast<TeenyMenuValue*>(item);
+      valueItem->editSteps = editSteps_;
+      valueItem->editStepsCount = editStepsCount_;
+    }
+};
+
+template <class V>
+const TeenyMenuValueOps TeenyMenuValue<V>::ops = {
+  &TeenyMenuValue<V>::getValue,
+  &TeenyMenuValue<V>::setValue,
+  &TeenyMenuValue<V>::stepValue,
+  &TeenyMenuValue<V>::getItemEditSteps,
+  &TeenyMenuValue<V>::setItemEditSteps,
+  &TeenyMenuValueTraits<V>::format,
+  sizeof(V),
+  TeenyMenuValueTraits<V>::isInteger()
+};
+
+#endif
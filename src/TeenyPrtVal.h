@@ -20,67 +20,277 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <Arduino.h>
 
+/********************************************************************/
+// Text formatters of TeenyPrtVal, kept apart from the display so that they can be used without one
+// (e.g. by TeenyMenuValue items, see TeenyMenuValue.h)
+class TeenyPrtFmt {
+  public:
+    /*
+      Formatters used by prt_int(), prt_uint(), prt_hex(), prt_float() and prt_fixed() (and fmt_str() matching
+      prt_str()), they don't depend on printf
+      nor allocate memory, and can be used on their own
+      Value is written left aligned into 'buf', truncated to 'len' characters and padded with spaces up to 'len',
+      then terminated, so 'buf' must hold at least len+1 characters
+      Return number of significant (non-padding) characters written
+    */
+    static int  fmt_str(char* buf, int len, const char* str) {
+            return(fmt_field(buf, len, str, strlen(str)));
+          }
+    static int  fmt_int(char* buf, int len, int32_t val) {
+            char digits[11];
+            uint32_t mag = (val < 0) ? 0u - (uint32_t)val : (uint32_t)val;
+            int n = fmt_dec(digits + sizeof(digits), mag);
+            if (val < 0)
+                    digits[sizeof(digits) - ++n] = '-';
+            return(fmt_field(buf, len, digits + sizeof(digits) - n, n));
+          }
+    static int  fmt_int64(char* buf, int len, int64_t val) {
+            char digits[20];
+            uint64_t mag = (val < 0) ? 0u - (uint64_t)val : (uint64_t)val;
+            int n = 0;
+            // Nine digits at a time, so that fmt_dec() divides 32-bit values only
+            while (mag > 999999999u) {
+                    uint64_t q = mag / 1000000000u;
+                    n += fmt_dec(digits + sizeof(digits) - n, (uint32_t)(mag - q * 1000000000u));
+                    while (n % 9 != 0)
+                            digits[sizeof(digits) - ++n] = '0';
+                    mag = q;
+            }
+            n += fmt_dec(digits + sizeof(digits) - n, (uint32_t)mag);
+            if (val < 0)
+                    digits[sizeof(digits) - ++n] = '-';
+            return(fmt_field(buf, len, digits + sizeof(digits) - n, n));
+          }
+    static int  fmt_uint(char* buf, int len, uint32_t val) {
+            char digits[10];
+            int n = fmt_dec(digits + sizeof(digits), val);
+            return(fmt_field(buf, len, digits + sizeof(digits) - n, n));
+          }
+    // 'width' - minimum number of hex digits, value is zero padded up to it (8 at most)
+    static int  fmt_hex(char* buf, int len, uint32_t val, int width = 0) {
+            static const char hexDigits[] = "0123456789ABCDEF";
+            char digits[8];
+            int n = 0;
+            do {
+                    digits[sizeof(digits) - ++n] = hexDigits[val & 0xF];
+                    val >>= 4;
+            } while (val != 0);
+            while (n < width && n < (int)sizeof(digits))
+                    digits[sizeof(digits) - ++n] = '0';
+            return(fmt_field(buf, len, digits + sizeof(digits) - n, n));
+          }
+    // 'prec' - number of decimals (0..9), value is rounded half away from zero
+    // Values beyond the uint32_t range are written as "ovf", like Arduino's Print does
+    static int  fmt_float(char* buf, int len, float val, int prec) {
+            if (isnan(val))
+                    return(fmt_field(buf, len, "nan", 3));
+            if (isinf(val))
+                    return((val < 0) ? fmt_field(buf, len, "-inf", 4) : fmt_field(buf, len, "inf", 3));
+            prec = constrain(prec, 0, 9);
+            boolean negative = (val < 0);
+            if (negative)
+                    val = -val;
+            if (val > 4294967040.0f)
+                    return(fmt_field(buf, len, negative ? "-ovf" : "ovf", negative ? 4 : 3));
+            // Integer part and its remainder are exact in float, the remainder is mant * 2^-shift (mant < 2^24),
+            // so that its decimals mant * 10^prec (< 2^54) are scaled and rounded exactly in 64-bit fixed point
+            uint32_t intPart = (uint32_t)val;
+            int exp;
+            uint32_t mant = (uint32_t)ldexp(frexp(val - intPart, &exp), 24);
+            int shift = 24 - exp;
+            uint64_t scaled = (uint64_t)mant * fmt_pow10(prec);
+            uint32_t frac = 0;
+            if (shift < 64) {
+                    // Rounded up if the bits shifted out are half or more
+                    frac = (uint32_t)(scaled >> shift) + (uint32_t)((scaled >> (shift - 1)) & 1);
+            }
+            if (frac >= fmt_pow10(prec)) {
+                    frac -= fmt_pow10(prec);
+                    intPart++;
+            }
+            char digits[24];
+            int n = fmt_decimal(digits + sizeof(digits), negative && (intPart != 0 || frac != 0), intPart, frac, prec);
+            return(fmt_field(buf, len, digits + sizeof(digits) - n, n));
+          }
+    // 'scale' - number of decimals held in 'val' (0..9), 'prec' - number of decimals written (0..9),
+    // dropped decimals are rounded half away from zero
+    static int  fmt_fixed(char* buf, int len, int32_t val, int scale, int prec) {
+            scale = constrain(scale, 0, 9);
+            prec = constrain(prec, 0, 9);
+            boolean negative = (val < 0);
+            uint32_t mag = negative ? 0u - (uint32_t)val : (uint32_t)val;
+            uint32_t intPart = mag / fmt_pow10(scale);
+            uint32_t frac = mag - intPart * fmt_pow10(scale);
+            if (prec < scale) {
+                    uint32_t div = fmt_pow10(scale - prec);
+                    frac = (frac + div / 2) / div;
+                    if (frac >= fmt_pow10(prec)) {
+                            frac -= fmt_pow10(prec);
+                            intPart++;
+                    }
+            } else {
+                    frac *= fmt_pow10(prec - scale);
+            }
+            char digits[24];
+            int n = fmt_decimal(digits + sizeof(digits), negative && (intPart != 0 || frac != 0), intPart, frac, prec);
+            return(fmt_field(buf, len, digits + sizeof(digits) - n, n));
+          }
+  protected:
+    // Write decimal digits of 'val' backwards, ending just before 'end', two digits per division, return number of digits
+    static int  fmt_dec(char* end, uint32_t val) {
+            static const char decPairs[] =
+                    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                    "8081828384858687888990919293949596979899";
+            char* p = end;
+            while (val >= 100) {
+                    uint32_t q = val / 100;
+                    const char* pair = &decPairs[(val - q * 100) * 2];
+                    *--p = pair[1];
+                    *--p = pair[0];
+                    val = q;
+            }
+            if (val >= 10) {
+                    *--p = decPairs[val * 2 + 1];
+                    *--p = decPairs[val * 2];
+            } else {
+                    *--p = '0' + val;
+            }
+            return(end - p);
+          }
+    // Write "[-]intPart[.frac]" backwards, ending just before 'end', with 'frac' zero padded to 'prec' digits,
+    // return number of characters
+    static int  fmt_decimal(char* end, boolean negative, uint32_t intPart, uint32_t frac, int prec) {
+            char* p = end;
+            if (prec > 0) {
+                    p -= fmt_dec(p, frac);
+                    while (end - p < prec)
+                            *--p = '0';
+                    *--p = '.';
+            }
+            p -= fmt_dec(p, intPart);
+            if (negative)
+                    *--p = '-';
+            return(end - p);
+          }
+    static uint32_t fmt_pow10(int exp) {
+            static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+            return(pow10[exp]);
+          }
+    // Copy 'n' characters of 'src' into 'buf', truncated and space padded to 'len' characters, and terminate it
+    static int  fmt_field(char* buf, int len, const char* src, int n) {
+            if (n > len)
+                    n = len;
+            for (int i=0; i<n; ++i)
+                    buf[i] = src[i];
+            for (int i=n; i<len; ++i)
+                    buf[i] = ' ';
+            buf[len] = '\0';
+            return(n);
+          }
+};
+
 /********************************************************************/
 template <class T>
-class TeenyPrtVal {
+class TeenyPrtVal : public TeenyPrtFmt {
   public:
     TeenyPrtVal(T& displayObj) : _displayObj(displayObj) {};
-    void  prt_int(uint32_t val, int len) {
+    /*
+      Draw text straight into a page-organized 1bpp frame buffer (SSD1306 layout: one byte per column of 8 rows,
+      bit 0 on top, pages of 'width' bytes), e.g. Adafruit_SSD1306::getBuffer(), instead of through print()
+      Glyph cells (6x8, built-in 5x7 font) are drawn opaque, 'inverse' clears glyph pixels and sets background ones
+      Assumes text size 1 and no rotation, text is clipped at the buffer edges instead of wrapped
+      Text with characters missing from the built-in font falls back to print(), nullptr turns the fast path off
+    */
+    void  setFrameBuffer(uint8_t* buffer, int16_t width, int16_t height, boolean inverse = false) {
+            _frameBuffer = buffer;
+            _frameWidth = width;
+            _frameHeight = height;
+            _frameInverse = inverse;
+          }
+    uint8_t* getFrameBuffer() {
+            return(_frameBuffer);
+          }
+#ifdef TEENYMENU_STATS
+    // Characters output since resetCharCount(), printed or blitted
+    uint32_t getCharCount() {
+            return(_charCount);
+          }
+    void  resetCharCount() {
+            _charCount = 0;
+          }
+#endif
+    void  prt_int(int32_t val, int len) {
             char sz[32];
-            sprintf(sz, "%ld", val);
-            sz[len] = 0;
-            for (int i=strlen(sz); i<len; ++i)
-                    sz[i] = ' ';
+            len = fmt_len(len, sizeof(sz));
+            fmt_int(sz, len, val);
             if (len > 0)
                     sz[len-1] = ' ';
-            sz[len] = '\0';
-            _displayObj.print(sz);
+            out_str(sz);
           }
-    void  prt_int(uint32_t val, int len, int col, int row) {
-            _displayObj.setCursor(col,row);
+    void  prt_int(int32_t val, int len, int col, int row) {
+            out_cursor(col,row);
             prt_int(val, len);
           }
+    void  prt_uint(uint32_t val, int len) {
+            char sz[32];
+            len = fmt_len(len, sizeof(sz));
+            fmt_uint(sz, len, val);
+            if (len > 0)
+                    sz[len-1] = ' ';
+            out_str(sz);
+          }
+    void  prt_uint(uint32_t val, int len, int col, int row) {
+            out_cursor(col,row);
+            prt_uint(val, len);
+          }
     void  prt_hex(uint32_t val, int len) {
             char sz[32];
-            //sprintf(sz, "%lX", val);
-            if (len < 2) sprintf(sz, "%lX", val);
-            else if (len < 4) sprintf(sz, "%02lX", val);
-            else if (len < 6) sprintf(sz, "%04lX", val);
-            else if (len < 8) sprintf(sz, "%06lX", val);
-            else sprintf(sz, "%08lX", val);
-            sz[len] = 0;
-            for (int i=strlen(sz); i<len; ++i)
-                    sz[i] = ' ';
+            len = fmt_len(len, sizeof(sz));
+            // Zero padded to 2, 4, 6 or 8 digits depending on field length
+            fmt_hex(sz, len, val, (len < 2) ? 0 : (len < 8) ? (len & ~1) : 8);
             if (len > 0)
                     sz[len-1] = ' ';
-            sz[len] = '\0';
-            _displayObj.print(sz);
+            out_str(sz);
           }
     void  prt_hex(uint32_t val, int len, int col, int row) {
-            _displayObj.setCursor(col,row);
+            out_cursor(col,row);
             prt_hex(val, len);
           }
     void  prt_float(float val, int len, int prec) {
-            String stz = String(val, prec);
-            char sz[len+1];
-            stz.toCharArray(sz, min(len, stz.length()+1));
-            for (int i=stz.length(); i<len; ++i) sz[i]=' ';
-            sz[len] = '\0';
-            _displayObj.print(sz);
+            char sz[32];
+            len = fmt_len(len, sizeof(sz));
+            fmt_float(sz, len, val, prec);
+            if (len > 0)
+                    sz[len-1] = ' ';
+            out_str(sz);
           }
     void  prt_float(float val, int len, int prec, int col, int row) {
-            _displayObj.setCursor(col,row);
+            out_cursor(col,row);
             prt_float(val, len, prec);
           }
+    // Fixed-point value 'val' scaled by 10^scale (e.g. 12345 with scale 2 is 123.45), printed with 'prec' decimals
+    void  prt_fixed(int32_t val, int len, int scale, int prec) {
+            char sz[32];
+            len = fmt_len(len, sizeof(sz));
+            fmt_fixed(sz, len, val, scale, prec);
+            if (len > 0)
+                    sz[len-1] = ' ';
+            out_str(sz);
+          }
+    void  prt_fixed(int32_t val, int len, int scale, int prec, int col, int row) {
+            out_cursor(col,row);
+            prt_fixed(val, len, scale, prec);
+          }
     void  prt_char(char pchar, int len) {
             char sz[32];
             sz[0] = pchar;
             for (int i=1; i<len; ++i) sz[i]=' ';
             sz[len] = '\0';
-            _displayObj.print(sz);
+            out_str(sz);
           }
     void  prt_char(char pchar, int len, int col, int row) {
-            _displayObj.setCursor(col,row);
+            out_cursor(col,row);
             prt_char(pchar, len);
           }
     void  prt_str(const char* str, int len) {
@@ -89,32 +299,251 @@ class TeenyPrtVal {
             for (int i=0; i<len; ++i)
               if(i<slen) {sz[i]=str[i];} else {sz[i]=' ';};
             sz[len] = '\0';
-            _displayObj.print(sz);
+            out_str(sz);
           }
     void  prt_str(const char* str, int len, int col, int row) {
-            _displayObj.setCursor(col,row);
+            out_cursor(col,row);
             prt_str(str, len);
           }
+    // Print 'sz' as it is, e.g. a field formatted earlier by one of the fmt_*() formatters
+    void  prt_buf(const char* sz) {
+            out_str(sz);
+          }
+    void  prt_buf(const char* sz, int col, int row) {
+            out_cursor(col,row);
+            prt_buf(sz);
+          }
     void  prt_date(uint16_t year, uint8_t month, uint8_t day) {
             char sz[32];
             sprintf(sz, "%02d/%02d/%02d", month, day, (year % 100));
-            _displayObj.print(sz);
+            out_str(sz);
           }
     void  prt_date(uint16_t year, uint8_t month, uint8_t day, int col, int row) {
-            _displayObj.setCursor(col,row);
+            out_cursor(col,row);
             prt_date(year, month, day);
           }
     void  prt_time(uint8_t hour, uint8_t min, uint8_t sec, uint8_t subsec) {
             char sz[32];
             sprintf(sz, "%02d:%02d:%02d:%02d", hour, min, sec, subsec);
-            _displayObj.print(sz);
+            out_str(sz);
           }
     void  prt_time(uint8_t hour, uint8_t min, uint8_t sec, uint8_t subsec, int col, int row) {
-            _displayObj.setCursor(col,row);
+            out_cursor(col,row);
             prt_time(hour, min, sec, subsec);
           }
+    // Column 'col' (0..5) of the 6x8 cell of 'c' in the built-in font, bit 0 is the top row
+    // Return -1 if the font has no glyph for 'c'
+    static int  font_column(char c, int col) {
+            int glyph = font_glyph(c);
+            if (glyph < 0)
+                    return(-1);
+            return((col >= 0 && col < 5) ? font_byte(glyph + col) : 0);
+          }
+  private:
+    // Field length clamped to what fits into a local buffer of 'size' characters
+    static int  fmt_len(int len, int size) {
+            return((len < 0) ? 0 : (len > size - 1) ? size - 1 : len);
+          }
+    // Offset of the 5 glyph columns of 'c' in font_data(), -1 if there is no glyph for it
+    // Covers printable ASCII and the code page 437 symbols used by TeenyMenu
+    static int  font_glyph(char c) {
+            byte code = (byte)c;
+            if (code >= 0x20 && code <= 0x7E)
+                    return((code - 0x20) * 5);
+            switch (code) {
+                    case 0x10: return(95 * 5);   // Arrow right
+                    case 0x11: return(96 * 5);   // Arrow left
+                    case 0x12: return(97 * 5);   // Arrows up/down
+                    case 0x1E: return(98 * 5);   // Arrow up
+                    case 0x1F: return(99 * 5);   // Arrow down
+                    case 0xAF: return(100 * 5);  // Bullet
+            }
+            return(-1);
+          }
+    static uint8_t font_byte(int offset) {
+#ifdef pgm_read_byte
+            return(pgm_read_byte(font_data() + offset));
+#else
+            return(font_data()[offset]);
+#endif
+          }
+    static const uint8_t* font_data() {
+            static const uint8_t font[]
+#ifdef PROGMEM
+            PROGMEM
+#endif
+            = {
+                    0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+                    0x00, 0x00, 0x5F, 0x00, 0x00,  // '!'
+                    0x00, 0x07, 0x00, 0x07, 0x00,  // '"'
+                    0x14, 0x7F, 0x14, 0x7F, 0x14,  // '#'
+                    0x24, 0x2A, 0x7F, 0x2A, 0x12,  // '$'
+                    0x23, 0x13, 0x08, 0x64, 0x62,  // '%'
+                    0x36, 0x49, 0x55, 0x22, 0x50,  // '&'
+                    0x00, 0x05, 0x03, 0x00, 0x00,  // '''
+                    0x00, 0x1C, 0x22, 0x41, 0x00,  // '('
+                    0x00, 0x41, 0x22, 0x1C, 0x00,  // ')'
+                    0x14, 0x08, 0x3E, 0x08, 0x14,  // '*'
+                    0x08, 0x08, 0x3E, 0x08, 0x08,  // '+'
+                    0x00, 0x50, 0x30, 0x00, 0x00,  // ','
+                    0x08, 0x08, 0x08, 0x08, 0x08,  // '-'
+                    0x00, 0x60, 0x60, 0x00, 0x00,  // '.'
+                    0x20, 0x10, 0x08, 0x04, 0x02,  // '/'
+                    0x3E, 0x51, 0x49, 0x45, 0x3E,  // '0'
+                    0x00, 0x42, 0x7F, 0x40, 0x00,  // '1'
+                    0x42, 0x61, 0x51, 0x49, 0x46,  // '2'
+                    0x21, 0x41, 0x45, 0x4B, 0x31,  // '3'
+                    0x18, 0x14, 0x12, 0x7F, 0x10,  // '4'
+                    0x27, 0x45, 0x45, 0x45, 0x39,  // '5'
+                    0x3C, 0x4A, 0x49, 0x49, 0x30,  // '6'
+                    0x01, 0x71, 0x09, 0x05, 0x03,  // '7'
+                    0x36, 0x49, 0x49, 0x49, 0x36,  // '8'
+                    0x06, 0x49, 0x49, 0x29, 0x1E,  // '9'
+                    0x00, 0x36, 0x36, 0x00, 0x00,  // ':'
+                    0x00, 0x56, 0x36, 0x00, 0x00,  // ';'
+                    0x08, 0x14, 0x22, 0x41, 0x00,  // '<'
+                    0x14, 0x14, 0x14, 0x14, 0x14,  // '='
+                    0x00, 0x41, 0x22, 0x14, 0x08,  // '>'
+                    0x02, 0x01, 0x51, 0x09, 0x06,  // '?'
+                    0x32, 0x49, 0x79, 0x41, 0x3E,  // '@'
+                    0x7E, 0x11, 0x11, 0x11, 0x7E,  // 'A'
+                    0x7F, 0x49, 0x49, 0x49, 0x36,  // 'B'
+                    0x3E, 0x41, 0x41, 0x41, 0x22,  // 'C'
+                    0x7F, 0x41, 0x41, 0x22, 0x1C,  // 'D'
+                    0x7F, 0x49, 0x49, 0x49, 0x41,  // 'E'
+                    0x7F, 0x09, 0x09, 0x09, 0x01,  // 'F'
+                    0x3E, 0x41, 0x49, 0x49, 0x7A,  // 'G'
+                    0x7F, 0x08, 0x08, 0x08, 0x7F,  // 'H'
+                    0x00, 0x41, 0x7F, 0x41, 0x00,  // 'I'
+                    0x20, 0x40, 0x41, 0x3F, 0x01,  // 'J'
+                    0x7F, 0x08, 0x14, 0x22, 0x41,  // 'K'
+                    0x7F, 0x40, 0x40, 0x40, 0x40,  // 'L'
+                    0x7F, 0x02, 0x0C, 0x02, 0x7F,  // 'M'
+                    0x7F, 0x04, 0x08, 0x10, 0x7F,  // 'N'
+                    0x3E, 0x41, 0x41, 0x41, 0x3E,  // 'O'
+                    0x7F, 0x09, 0x09, 0x09, 0x06,  // 'P'
+                    0x3E, 0x41, 0x51, 0x21, 0x5E,  // 'Q'
+                    0x7F, 0x09, 0x19, 0x29, 0x46,  // 'R'
+                    0x46, 0x49, 0x49, 0x49, 0x31,  // 'S'
+                    0x01, 0x01, 0x7F, 0x01, 0x01,  // 'T'
+                    0x3F, 0x40, 0x40, 0x40, 0x3F,  // 'U'
+                    0x1F, 0x20, 0x40, 0x20, 0x1F,  // 'V'
+                    0x3F, 0x40, 0x38, 0x40, 0x3F,  // 'W'
+                    0x63, 0x14, 0x08, 0x14, 0x63,  // 'X'
+                    0x07, 0x08, 0x70, 0x08, 0x07,  // 'Y'
+                    0x61, 0x51, 0x49, 0x45, 0x43,  // 'Z'
+                    0x00, 0x7F, 0x41, 0x41, 0x00,  // '['
+                    0x02, 0x04, 0x08, 0x10, 0x20,  // '\'
+                    0x00, 0x41, 0x41, 0x7F, 0x00,  // ']'
+                    0x04, 0x02, 0x01, 0x02, 0x04,  // '^'
+                    0x40, 0x40, 0x40, 0x40, 0x40,  // '_'
+                    0x00, 0x01, 0x02, 0x04, 0x00,  // '`'
+                    0x20, 0x54, 0x54, 0x54, 0x78,  // 'a'
+                    0x7F, 0x48, 0x44, 0x44, 0x38,  // 'b'
+                    0x38, 0x44, 0x44, 0x44, 0x20,  // 'c'
+                    0x38, 0x44, 0x44, 0x48, 0x7F,  // 'd'
+                    0x38, 0x54, 0x54, 0x54, 0x18,  // 'e'
+                    0x08, 0x7E, 0x09, 0x01, 0x02,  // 'f'
+                    0x0C, 0x52, 0x52, 0x52, 0x3E,  // 'g'
+                    0x7F, 0x08, 0x04, 0x04, 0x78,  // 'h'
+                    0x00, 0x44, 0x7D, 0x40, 0x00,  // 'i'
+                    0x20, 0x40, 0x44, 0x3D, 0x00,  // 'j'
+                    0x7F, 0x10, 0x28, 0x44, 0x00,  // 'k'
+                    0x00, 0x41, 0x7F, 0x40, 0x00,  // 'l'
+                    0x7C, 0x04, 0x18, 0x04, 0x78,  // 'm'
+                    0x7C, 0x08, 0x04, 0x04, 0x78,  // 'n'
+                    0x38, 0x44, 0x44, 0x44, 0x38,  // 'o'
+                    0x7C, 0x14, 0x14, 0x14, 0x08,  // 'p'
+                    0x08, 0x14, 0x14, 0x18, 0x7C,  // 'q'
+                    0x7C, 0x08, 0x04, 0x04, 0x08,  // 'r'
+                    0x48, 0x54, 0x54, 0x54, 0x20,  // 's'
+                    0x04, 0x3F, 0x44, 0x40, 0x20,  // 't'
+                    0x3C, 0x40, 0x40, 0x20, 0x7C,  // 'u'
+                    0x1C, 0x20, 0x40, 0x20, 0x1C,  // 'v'
+                    0x3C, 0x40, 0x30, 0x40, 0x3C,  // 'w'
+                    0x44, 0x28, 0x10, 0x28, 0x44,  // 'x'
+                    0x0C, 0x50, 0x50, 0x50, 0x3C,  // 'y'
+                    0x44, 0x64, 0x54, 0x4C, 0x44,  // 'z'
+                    0x00, 0x08, 0x36, 0x41, 0x00,  // '{'
+                    0x00, 0x00, 0x7F, 0x00, 0x00,  // '|'
+                    0x00, 0x41, 0x36, 0x08, 0x00,  // '}'
+                    0x08, 0x04, 0x08, 0x10, 0x08,  // '~'
+                    0x7F, 0x3E, 0x1C, 0x08, 0x00,  // 0x10 arrow right
+                    0x00, 0x08, 0x1C, 0x3E, 0x7F,  // 0x11 arrow left
+                    0x14, 0x22, 0x7F, 0x22, 0x14,  // 0x12 arrows up/down
+                    0x30, 0x38, 0x3E, 0x38, 0x30,  // 0x1E arrow up
+                    0x06, 0x0E, 0x3E, 0x0E, 0x06,  // 0x1F arrow down
+                    0x22, 0x14, 0x2A, 0x14, 0x08,  // 0xAF bullet
+            };
+            return(font);
+          }
+    // Move the text cursor, kept here as well since blitted text doesn't advance the display cursor
+    void  out_cursor(int col, int row) {
+            _col = col;
+            _row = row;
+            _displayObj.setCursor(col,row);
+          }
+    // Output formatted text at the text cursor, blitted into the frame buffer if one is set, otherwise printed
+    void  out_str(const char* sz) {
+            int n = strlen(sz);
+#ifdef TEENYMENU_STATS
+            _charCount += n;
+#endif
+            if (_frameBuffer == nullptr) {
+                    _displayObj.print(sz);
+            } else if (!blit_str(sz)) {
+                    _displayObj.setCursor(_col,_row);
+                    _displayObj.print(sz);
+            }
+            _col += n * 6;
+          }
+    // Copy glyph columns of 'str' into the frame buffer at the text cursor
+    // A cell on a page-aligned row takes one byte store per column, otherwise each column is split
+    // across two pages with masks. Return false, without drawing anything, if a glyph is missing
+    boolean blit_str(const char* str) {
+            for (const char* p = str; *p; ++p)
+                    if (font_glyph(*p) < 0)
+                            return(false);
+            if (_row <= -8 || _row >= _frameHeight)
+                    return(true);
+            int page = (_row < 0) ? -1 : _row / 8;
+            int shift = _row - page * 8;
+            int pages = (_frameHeight + 7) / 8;
+            uint8_t* top = (page >= 0) ? _frameBuffer + page * _frameWidth : nullptr;
+            uint8_t* bottom = (shift != 0 && page + 1 < pages) ? _frameBuffer + (page + 1) * _frameWidth : nullptr;
+            uint8_t topMask = 0xFF << shift;
+            int x = _col;
+            for (const char* p = str; *p && x < _frameWidth; ++p) {
+                    int glyph = font_glyph(*p);
+                    for (int i=0; i<6; ++i, ++x) {
+                            if (x < 0 || x >= _frameWidth)
+                                    continue;
+                            uint8_t bits = (i < 5) ? font_byte(glyph + i) : 0;
+                            if (_frameInverse)
+                                    bits = ~bits;
+                            if (shift == 0) {
+                                    top[x] = bits;
+                                    continue;
+                            }
+                            if (top != nullptr)
+                                    top[x] = (top[x] & ~topMask) | (uint8_t)(bits << shift);
+                            if (bottom != nullptr)
+                                    bottom[x] = (bottom[x] & topMask) | (bits >> (8 - shift));
+                    }
+            }
+            return(true);
+          }
   private:
     T& _displayObj;
+    int _col = 0;
+    int _row = 0;
+    uint8_t* _frameBuffer = nullptr;
+    int16_t _frameWidth = 0;
+    int16_t _frameHeight = 0;
+    boolean _frameInverse = false;
+#ifdef TEENYMENU_STATS
+    uint32_t _charCount = 0;
+#endif
 };
 
 #endif //TEENYPRTVAL_H